@@ -0,0 +1,645 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "bot.hpp"
+
+const float EPSILON = 0.01;
+const int PLAN_TILE_ROWS = 4;
+const int DEADLINE_CHECK_INTERVAL = 16;
+
+struct PlanTask
+{
+    const MapSnapshot *present_map;
+    const ForceField *force_field;
+    unsigned char my_id;
+    std::vector<SquarePlan> *plans;
+};
+
+//Fills weights[STILL] for the site itself and weights[dir] for its neighbor in dir. A square at distance d from the
+//weighted location is pulled towards location with weight / d^3.
+void get_force_sources(int index, const MapSnapshot &present_map, int my_id, float weights[5])
+{
+    const StencilPlanes &planes = present_map.planes;
+    for(int i = 0; i < 5; i++)
+    {
+        weights[i] = 0.0;
+    }
+    if(present_map.owner[index] == 0)
+    {
+        int num_neighbors = 0;
+
+        for(int i = 0; i < 4; i++)
+        {
+            unsigned char dir = CARDINALS[i];
+            int neighbor = present_map.neighbor(index, dir);
+            if(present_map.owner[neighbor] != my_id)
+            {
+                weights[dir] = planes.ratio[neighbor];
+                num_neighbors++;
+            }
+        }
+        weights[STILL] = planes.ratio[index];
+        for(int i = 0; i < 5; i++)
+        {
+            weights[i] /= (num_neighbors + 1);
+        }
+    }
+    else//that is, if owner is not in (0, myID)
+    {
+        weights[STILL] = present_map.production[index];
+        for(int i = 0; i < 4; i++)
+        {
+            unsigned char dir = CARDINALS[i];
+            weights[dir] = planes.enemy_strength[present_map.neighbor(index, dir)];
+        }
+    }
+}
+
+float compute_force(int original_index, int index, const MapSnapshot &present_map, float dist, int my_id)
+{
+    const std::vector<double> &falloff = present_map.offsets->falloff;
+    float weights[5];
+    get_force_sources(index, present_map, my_id, weights);
+    float force = weights[STILL] * (float) falloff[(int) dist];
+    for(int i = 0; i < 4; i++)
+    {
+        unsigned char dir = CARDINALS[i];
+        if(weights[dir] != 0.0)
+        {
+            force += weights[dir] * (float) falloff[present_map.offsets->distance(original_index, present_map.neighbor(index, dir))];
+        }
+    }
+	return force;
+}
+
+//Both are lookups into the planes update_snapshot_planes computed this frame, which must have been built for the
+//my_id the caller passes; it is kept so that callers still say whose view they want
+float heuristic(int index, const MapSnapshot &present_map, unsigned char /*my_id*/)
+{
+    return present_map.planes.value[index];
+}
+
+bool is_on_border(int index, const MapSnapshot &present_map, unsigned char /*my_id*/)
+{
+    return present_map.planes.border[index] != 0;
+}
+
+int get_best_target_on_border_location(const MapSnapshot &present_map, unsigned char my_id)
+{
+    float max_val = -1.0;
+    int best_index = 0;
+    for(int index = 0; index < present_map.cells; index++)
+    {
+        if (present_map.owner[index] == my_id)
+        {
+            for(int i = 0; i < 4; i++)
+            {
+                int neighbor = present_map.neighbor(index, CARDINALS[i]);
+                if(present_map.owner[neighbor] != my_id)
+                {
+                    float curr_val = heuristic(neighbor, present_map, my_id);
+                    if(curr_val > max_val)
+                    {
+                        max_val = curr_val;
+                        best_index = neighbor;
+                    }
+                }
+
+            }
+        }
+    }
+    return best_index;
+}
+unsigned char get_force_direction(float force_x, float force_y)
+{
+    if(force_x + force_y > 0 && force_x - force_y > 0)
+    {
+        return EAST;
+    }
+    else if(force_x + force_y > 0 && force_x - force_y < 0)
+    {
+        return SOUTH;
+    }
+    else if(force_x + force_y < 0 && force_x - force_y < 0)
+    {
+        return WEST;
+    }
+    else if(force_x + force_y < 0 && force_x - force_y > 0)
+    {
+        return NORTH;
+    }
+    return STILL;
+}
+
+void plan_square(int index, const MapSnapshot &present_map, const ForceField &force_field, unsigned char my_id, SquarePlan &plan)
+{
+    plan.on_border = is_on_border(index, present_map, my_id);
+    plan.weak = is_weak(index, present_map);
+    plan.direction = STILL;
+    plan.num_targets = 0;
+    plan.contact = false;
+    if(!plan.on_border)
+    {
+        float force_x;
+        float force_y;
+        get_force(force_field, present_map.location(index), force_x, force_y);
+        plan.direction = get_force_direction(force_x, force_y);
+    }
+    else
+    {
+        for(int i = 0; i < 4; i++)
+        {
+            int curr = present_map.neighbor(index, CARDINALS[i]);
+            if(present_map.owner[curr] != my_id)
+            {
+                float curr_val = heuristic(curr, present_map, my_id);
+                int j = plan.num_targets;
+                while((j > 0) && (plan.values[j - 1] < curr_val))//equal values keep CARDINALS order
+                {
+                    plan.targets[j] = plan.targets[j - 1];
+                    plan.values[j] = plan.values[j - 1];
+                    j--;
+                }
+                plan.targets[j] = CARDINALS[i];
+                plan.values[j] = curr_val;
+                plan.num_targets++;
+            }
+        }
+    }
+}
+
+void plan_tile(void *context, int begin, int end)
+{
+    PlanTask &task = *static_cast<PlanTask *>(context);
+    for(int index = begin; index < end; index++)
+    {
+        if(task.present_map->owner[index] == task.my_id)
+        {
+            plan_square(index, *task.present_map, *task.force_field, task.my_id, (*task.plans)[index]);
+        }
+    }
+}
+int get_planner_threads()
+{
+    const char *threads = getenv("BOT_THREADS");
+    if(threads != NULL)
+    {
+        return std::max(1, atoi(threads));
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+//Patches territory for the squares listed in present_map.changed. Border membership, value and scan order of a
+//square depend only on the square and its neighbors, so only those are revisited.
+void update_territory(Territory &territory, const MapSnapshot &present_map, unsigned char my_id)
+{
+    territory.stamp++;
+    for(size_t c = 0; c < present_map.changed.size(); c++)
+    {
+        int changed = present_map.changed[c];
+        for(int d = 0; d < 5; d++)
+        {
+            int index = present_map.neighbor(changed, DIRECTIONS[d]);
+            if(territory.visited[index] == territory.stamp)
+            {
+                continue;
+            }
+            territory.visited[index] = territory.stamp;
+
+            int scan_order = -1;
+            if(present_map.owner[index] != my_id)
+            {
+                for(int i = 0; i < 4; i++)
+                {
+                    int neighbor = present_map.neighbor(index, CARDINALS[i]);
+                    int order = 4 * neighbor + (i + 2) % 4;//the neighbor reaches index in the opposite direction
+                    if((present_map.owner[neighbor] == my_id) && ((scan_order == -1) || (order < scan_order)))
+                    {
+                        scan_order = order;
+                    }
+                }
+            }
+            if(scan_order != -1)
+            {
+                add_border(territory, index, heuristic(index, present_map, my_id), scan_order);
+            }
+            else
+            {
+                remove_border(territory, index);
+            }
+        }
+        bool was_mine = (territory.mine[changed] != 0);
+        bool is_mine = (present_map.owner[changed] == my_id);
+        if(was_mine != is_mine)
+        {
+            territory.mine[changed] = is_mine;
+            territory.my_area += is_mine ? 1 : -1;
+        }
+    }
+}
+
+
+//Adds the candidate of stepping from start in direction: capturing the square there when we do not own it and are
+//stronger, joining it when we do. Adds nothing for STILL or a capture we are too weak for.
+void add_step_candidate(int start, unsigned char direction, int goal, const MapSnapshot &present_map, unsigned char my_id,
+                        MoveResolver &resolver)
+{
+    if(direction == STILL)
+    {
+        return;
+    }
+    int next = present_map.neighbor(start, direction);
+    if((present_map.owner[next] != my_id) && (present_map.strength[start] <= present_map.strength[next]))
+    {
+        return;
+    }
+    add_move_candidate(resolver, start, direction, TRACE_TOWARDS_TARGET, STRENGTH_CAP, goal);
+}
+
+//Squares that are not refined before the deadline send this move: interior squares follow the flow field towards
+//the border, everybody else waits.
+unsigned char get_cheap_direction(int index, const MapSnapshot &present_map, const FlowField &flow, unsigned char my_id)
+{
+    if(is_on_border(index, present_map, my_id) || is_weak(index, present_map) || (flow.cost[index] == -1))
+    {
+        return STILL;
+    }
+    return flow.direction[index];
+}
+
+//Order in which candidates are listed while time lasts, which is also their priority in the MoveResolver: border
+//squares in scan order, then interior squares from the strongest to the weakest (scan order among equals).
+void get_refine_order(const MapSnapshot &present_map, const std::vector<SquarePlan> &plans, unsigned char my_id, std::vector<int> &order)
+{
+    int counts[256] = {0};
+    order.clear();
+    for(int index = 0; index < present_map.cells; index++)
+    {
+        if(present_map.owner[index] == my_id)
+        {
+            if(plans[index].on_border)
+            {
+                order.push_back(index);
+            }
+            else
+            {
+                counts[255 - present_map.strength[index]]++;
+            }
+        }
+    }
+    int position = order.size();
+    for(int i = 0; i < 256; i++)
+    {
+        int count = counts[i];
+        counts[i] = position;
+        position += count;
+    }
+    order.resize(position);
+    for(int index = 0; index < present_map.cells; index++)
+    {
+        if((present_map.owner[index] == my_id) && !plans[index].on_border)
+        {
+            order[counts[255 - present_map.strength[index]]++] = index;
+        }
+    }
+}
+
+//Contact squares are border squares strong enough to take a contested target (see is_contested). They are grouped
+//into zones of neighboring squares (diagonals included) and the frontier simulation chooses which of them capture
+//and which hold. Zones are cut at ZONE_MAX_SQUARES squares or ZONE_MAX_CANDIDATES move combinations; squares left
+//when the deadline passes keep the greedy plan.
+void plan_contact_zones(Bot &bot)
+{
+    const MapSnapshot &snapshot = bot.snapshot;
+    FrontierSim &sim = bot.frontier;
+    std::vector<int> &contacts = sim.contacts;
+    contacts.clear();
+    for(size_t i = 0; (i < bot.refine_order.size()) && bot.plans[bot.refine_order[i]].on_border; i++)
+    {
+        int index = bot.refine_order[i];
+        SquarePlan &plan = bot.plans[index];
+        plan.num_contested = 0;
+        for(int t = 0; (t < plan.num_targets) && !plan.weak; t++)
+        {
+            int target = snapshot.neighbor(index, plan.targets[t]);
+            if((snapshot.strength[index] > snapshot.strength[target]) && is_contested(target, snapshot, bot.my_id))
+            {
+                plan.contested[plan.num_contested++] = plan.targets[t];
+            }
+        }
+        if(plan.num_contested > 0)
+        {
+            sim.contact[index] = 1;
+            contacts.push_back(index);
+        }
+    }
+    std::vector<int> &group = sim.group;
+    unsigned char targets[ZONE_MAX_SQUARES][4];
+    unsigned char num_targets[ZONE_MAX_SQUARES];
+    unsigned char directions[ZONE_MAX_SQUARES];
+    for(size_t i = 0; i < contacts.size(); i++)
+    {
+        if(sim.assigned[contacts[i]])
+        {
+            continue;
+        }
+        if(bot.deadline.expired())
+        {
+            break;
+        }
+        group.clear();
+        group.push_back(contacts[i]);
+        sim.assigned[contacts[i]] = 1;
+        int candidates = bot.plans[contacts[i]].num_contested + 1;
+        for(size_t g = 0; g < group.size(); g++)
+        {
+            for(int dy = -1; dy <= 1; dy++)
+            {
+                int row = snapshot.neighbor(group[g], (dy < 0) ? NORTH : ((dy > 0) ? SOUTH : STILL));
+                for(int dx = -1; dx <= 1; dx++)
+                {
+                    int index = snapshot.neighbor(row, (dx < 0) ? WEST : ((dx > 0) ? EAST : STILL));
+                    int options = bot.plans[index].num_contested + 1;
+                    if(!sim.contact[index] || sim.assigned[index] || (group.size() == (size_t) ZONE_MAX_SQUARES) ||
+                       (candidates * options > ZONE_MAX_CANDIDATES))
+                    {
+                        continue;
+                    }
+                    sim.assigned[index] = 1;
+                    candidates *= options;
+                    group.push_back(index);
+                }
+            }
+        }
+        for(size_t g = 0; g < group.size(); g++)
+        {
+            const SquarePlan &plan = bot.plans[group[g]];
+            std::copy(plan.contested, plan.contested + plan.num_contested, targets[g]);
+            num_targets[g] = plan.num_contested;
+        }
+        solve_zone(sim, snapshot, bot.my_id, group, targets, num_targets, directions);
+        bot.trace.trace(TRACE_CONTACT_ZONE, group[0], -1, STILL, group.size());
+        for(size_t g = 0; g < group.size(); g++)
+        {
+            bot.plans[group[g]].contact = true;
+            bot.plans[group[g]].contact_direction = directions[g];
+        }
+    }
+    for(size_t i = 0; i < contacts.size(); i++)
+    {
+        sim.contact[contacts[i]] = 0;
+        sim.assigned[contacts[i]] = 0;
+    }
+}
+
+//Lists the moves of a square we own, best first, from its plan alone. Border squares capture the contact zone's
+//choice or their targets, best first; if they are not too weak they then step towards their assigned target or
+//along the flow field, unless that leads into a contested square the frontier simulation kept them out of.
+//Interior squares that are not too weak follow their assigned target or the force field.
+void add_move_candidates(int index, const SquarePlan &plan, const MapSnapshot &present_map, unsigned char my_id,
+                         const FlowField &flow, const TargetAssignment &assignment, MoveResolver &resolver)
+{
+    unsigned char strength = present_map.strength[index];
+    bool assigned = (assignment.slot[index] != -1);
+    add_move_square(resolver, index);
+    if(!plan.on_border)
+    {
+        unsigned char wanted = assigned ? assignment.direction[index] : plan.direction;
+        if(!plan.weak && (wanted != STILL))
+        {
+            add_move_candidate(resolver, index, wanted, TRACE_INTERIOR, CAP_BOUND, present_map.neighbor(index, wanted));
+        }
+        return;
+    }
+    unsigned captured = 0;//bitmask of the directions already listed as captures
+    if(plan.contact && (plan.contact_direction != STILL))//the frontier simulation chose a contested target
+    {
+        add_move_candidate(resolver, index, plan.contact_direction, TRACE_CAPTURE, CAP_BOUND,
+                           present_map.neighbor(index, plan.contact_direction));
+        captured |= 1 << plan.contact_direction;
+    }
+    for(int i = 0; i < plan.num_targets; i++)
+    {
+        int curr = present_map.neighbor(index, plan.targets[i]);
+        if(plan.contact && (std::find(plan.contested, plan.contested + plan.num_contested, plan.targets[i]) !=
+                            plan.contested + plan.num_contested))
+        {
+            continue;//it told us to keep out of the fight
+        }
+        if(strength > present_map.strength[curr])
+        {
+            add_move_candidate(resolver, index, plan.targets[i], TRACE_CAPTURE, CAP_BOUND, curr);
+            captured |= 1 << plan.targets[i];
+        }
+    }
+    unsigned char step = assigned ? assignment.direction[index] : flow.direction[index];
+    if(plan.weak || (!assigned && (flow.cost[index] == -1)) || (captured & (1 << step)) ||
+       (plan.contact && is_contested(present_map.neighbor(index, step), present_map, my_id)))
+    {
+        return;
+    }
+    add_step_candidate(index, step, assigned ? assignment.targets[assignment.slot[index]] : flow.target[index],
+                       present_map, my_id, resolver);
+}
+
+//Same sources as plan_moves adds, from the predicted frame. Every border square only ever adds to its own square, so
+//the order they are added in does not change the sums.
+void speculate_force_sources(ForceSpeculation &speculation, void *bot)
+{
+    unsigned char my_id = ((const Bot *) bot)->my_id;
+    MapSnapshot &predicted = speculation.predicted;
+    ForceField &field = speculation.field;
+    predict_next_frame(speculation, my_id);
+    update_snapshot_planes(predicted, my_id);
+    for(int d = 0; d < 5; d++)
+    {
+        field.source[d].assign(predicted.cells, 0.0);//a reused direction left the real frame's sources behind
+        field.has_sources[d] = false;
+        field.transformed[d] = false;
+    }
+    for(int index = 0; index < predicted.cells; index++)
+    {
+        if(predicted.owner[index] == my_id)
+        {
+            continue;
+        }
+        bool on_border = false;
+        for(int i = 0; i < 4; i++)
+        {
+            on_border |= (predicted.owner[predicted.neighbor(index, CARDINALS[i])] == my_id);
+        }
+        if(on_border)
+        {
+            float weights[5];
+            get_force_sources(index, predicted, my_id, weights);
+            for(int d = 0; d < 5; d++)
+            {
+                add_force_source(field, predicted.location(index), DIRECTIONS[d], weights[d]);
+            }
+        }
+    }
+    for(int d = 0; d < 5; d++)
+    {
+        std::copy(field.source[d].begin(), field.source[d].end(), speculation.sources[d].begin());
+    }
+    speculation.built.store(true);
+    for(int d = 0; d < 5; d++)
+    {
+        if(speculation.is_cancelled())
+        {
+            return;
+        }
+        if(field.has_sources[d] && (speculation.wanted.load() & (1 << d)))
+        {
+            transform_force_sources(field, d);
+            speculation.ready[d] = true;
+        }
+    }
+}
+
+void init_bot(Bot &bot, unsigned char my_id, const hlt::GameMap &present_map, WorkerPool &pool, MapTableCache *tables)
+{
+    bot.my_id = my_id;
+    if(tables != NULL)
+    {
+        bot.tables = tables->get(present_map.width, present_map.height);
+    }
+    else
+    {
+        bot.tables = make_map_tables(present_map.width, present_map.height);
+    }
+    init_map_snapshot(bot.snapshot, *bot.tables);
+    for(int index = 0; index < bot.snapshot.cells; index++)
+    {
+        hlt::Location location = bot.snapshot.location(index);
+        bot.snapshot.production[index] = present_map.contents[location.y][location.x].production;//frames do not repeat it
+    }
+    init_force_field(bot.force_field, bot.tables->force_kernels);
+    init_move_resolver(bot.resolver, bot.snapshot.cells);
+    init_territory(bot.territory, bot.snapshot.cells);
+    init_flow_field(bot.flow, bot.snapshot.cells);
+    init_frontier_sim(bot.frontier, bot.snapshot.cells);
+    init_target_assignment(bot.assignment, bot.snapshot.cells);
+    bot.plans.assign(bot.snapshot.cells, SquarePlan());
+    bot.directions.assign(bot.snapshot.cells, STILL);
+    bot.refine_order.clear();
+    bot.refine_order.reserve(bot.snapshot.cells);
+    bot.pool = &pool;
+    init_frame_deadline(bot.deadline);
+    init_frame_profiler(bot.profiler, bot.snapshot.width, bot.snapshot.height);
+    bot.speculation.finish();//left over from a previous game, start_game_session enables it again
+    bot.speculation.enabled = false;
+}
+
+void plan_moves(Bot &bot)
+{
+    MapSnapshot &snapshot = bot.snapshot;
+    unsigned char my_id = bot.my_id;
+    update_snapshot_planes(snapshot, my_id);
+    update_territory(bot.territory, snapshot, my_id);
+    update_flow_field(bot.flow, snapshot, bot.territory, my_id);
+    end_phase(bot.profiler, PHASE_PREPARE);
+    int best_target_on_border = bot.territory.best_target();
+    bot.trace.frame++;
+    bot.trace.trace(TRACE_FRAME, best_target_on_border, -1, STILL, bot.territory.my_area);
+    #ifdef DEBUG
+        if(best_target_on_border != get_best_target_on_border_location(snapshot, my_id))
+        {
+            bot.trace.trace(TRACE_TERRITORY_MISMATCH, best_target_on_border, get_best_target_on_border_location(snapshot, my_id));
+        }
+    #endif // DEBUG
+
+    for (int index = 0; index < snapshot.cells; index++)
+    {
+        if (snapshot.owner[index] == my_id)
+        {
+            bot.directions[index] = get_cheap_direction(index, snapshot, bot.flow, my_id);
+        }
+    }
+    end_phase(bot.profiler, PHASE_FALLBACK);
+
+    if (!bot.deadline.expired())
+    {
+        clear_force_sources(bot.force_field);
+        for (size_t i = 0; i < bot.territory.border.size(); i++)
+        {
+            float weights[5];
+            get_force_sources(bot.territory.border[i], snapshot, my_id, weights);
+            for(int d = 0; d < 5; d++)
+            {
+                add_force_source(bot.force_field, snapshot.location(bot.territory.border[i]), DIRECTIONS[d], weights[d]);
+            }
+        }
+        if(bot.speculation.enabled)
+        {
+            bot.trace.trace(TRACE_SPECULATION, -1, -1, STILL, reuse_speculative_sources(bot.speculation, bot.force_field));
+        }
+        compute_force_field(bot.force_field);
+        end_phase(bot.profiler, PHASE_FORCE);
+
+        PlanTask plan_task = {&snapshot, &bot.force_field, my_id, &bot.plans};
+        bot.pool->run(snapshot.cells, PLAN_TILE_ROWS * snapshot.width, plan_tile, &plan_task);
+        get_refine_order(snapshot, bot.plans, my_id, bot.refine_order);
+        end_phase(bot.profiler, PHASE_PLAN);
+        plan_contact_zones(bot);
+        end_phase(bot.profiler, PHASE_CONTACT);
+        update_target_assignment(bot.assignment, snapshot, bot.territory, my_id);
+        end_phase(bot.profiler, PHASE_ASSIGN);
+
+        clear_move_candidates(bot.resolver);
+        size_t listed = 0;
+        for (; listed < bot.refine_order.size(); listed++)
+        {
+            if ((listed % DEADLINE_CHECK_INTERVAL == 0) && bot.deadline.expired())
+            {
+                bot.trace.trace(TRACE_DEADLINE, -1, -1, STILL, bot.refine_order.size() - listed);
+                break;
+            }
+            int index = bot.refine_order[listed];
+            add_move_candidates(index, bot.plans[index], snapshot, my_id, bot.flow, bot.assignment, bot.resolver);
+        }
+        for (size_t i = listed; i < bot.refine_order.size(); i++)//the cheap move is still checked against the caps
+        {
+            int index = bot.refine_order[i];
+            add_move_square(bot.resolver, index);
+            if (bot.directions[index] != STILL)
+            {
+                add_move_candidate(bot.resolver, index, bot.directions[index], TRACE_TOWARDS_TARGET, STRENGTH_CAP,
+                                   bot.flow.target[index]);
+            }
+        }
+        end_phase(bot.profiler, PHASE_CANDIDATES);
+        resolve_moves(bot.resolver, snapshot, my_id, bot.directions);
+        for (size_t i = 0; i < bot.refine_order.size(); i++)
+        {
+            int index = bot.refine_order[i];
+            const MoveCandidate *move = get_resolved_candidate(bot.resolver, index);
+            if (move == NULL)
+            {
+                bot.trace.trace(TRACE_WAIT, index, -1, STILL, snapshot.strength[index]);
+            }
+            else
+            {
+                int next = snapshot.neighbor(index, move->direction);
+                bot.trace.trace((TraceEvent) move->event, index, move->goal, move->direction, snapshot.strength[index]);
+                bot.trace.trace((snapshot.owner[next] == my_id) ? TRACE_RESERVE_OWN : TRACE_RESERVE_ENEMY, index, next,
+                                move->direction, bot.resolver.load[next]);
+            }
+            bot.trace.trace(TRACE_DIRECTION, index, -1, bot.directions[index]);
+        }
+        carry_target_assignment(bot.assignment, snapshot, bot.directions);
+        end_phase(bot.profiler, PHASE_RESOLVE);
+    }
+}
+
+void plan_frame(Bot &bot, const hlt::GameMap &present_map)
+{
+    start_profiled_frame(bot.profiler, bot.deadline);
+    update_map_snapshot(bot.snapshot, present_map);
+    end_phase(bot.profiler, PHASE_READ);
+    plan_moves(bot);
+}
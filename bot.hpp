@@ -0,0 +1,81 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <memory>
+#include <vector>
+
+#include "hlt.hpp"
+#include "force_field.hpp"
+#include "map_tables.hpp"
+#include "map_snapshot.hpp"
+#include "territory.hpp"
+#include "flow_field.hpp"
+#include "force_speculation.hpp"
+#include "frontier_sim.hpp"
+#include "target_assignment.hpp"
+#include "move_resolver.hpp"
+#include "worker_pool.hpp"
+#include "frame_deadline.hpp"
+#include "frame_profiler.hpp"
+#include "trace_log.hpp"
+
+//Everything about a square's move that does not depend on what other squares do this frame. Plans are built in
+//parallel, turned into ranked move candidates and resolved for all squares at once by the MoveResolver.
+struct SquarePlan
+{
+    bool on_border;
+    bool weak;
+    unsigned char direction;//interior squares: where the force field points, STILL if nowhere
+    unsigned char num_targets;
+    unsigned char targets[4];//border squares: neighbors we do not own, highest heuristic first
+    float values[4];
+    unsigned char num_contested;
+    unsigned char contested[4];//targets an enemy owns or touches and we are stronger than
+    bool contact;//the frontier simulation chose between the contested targets and holding
+    unsigned char contact_direction;
+};
+
+//Per-game state of the bot. MyBot.cpp feeds it frames read from the environment, tools/ feed it frames from the
+//local simulator, so nothing in here may read stdin or write stdout.
+struct Bot
+{
+    unsigned char my_id;
+    std::shared_ptr<const MapTables> tables;//read-only, possibly shared with other games
+    MapSnapshot snapshot;
+    ForceField force_field;
+    Territory territory;
+    FlowField flow;
+    FrontierSim frontier;
+    TargetAssignment assignment;
+    MoveResolver resolver;
+    std::vector<SquarePlan> plans;
+    std::vector<unsigned char> directions;
+    std::vector<int> refine_order;
+    WorkerPool *pool;
+    FrameDeadline deadline;
+    FrameProfiler profiler;
+    TraceLog trace;//disabled unless opened
+    ForceSpeculation speculation;//disabled unless initialized, last so that its thread stops first
+};
+
+float compute_force(int original_index, int index, const MapSnapshot &present_map, float dist, int my_id);
+float heuristic(int index, const MapSnapshot &present_map, unsigned char my_id);
+bool is_on_border(int index, const MapSnapshot &present_map, unsigned char my_id);
+int get_best_target_on_border_location(const MapSnapshot &present_map, unsigned char my_id);
+void add_step_candidate(int start, unsigned char direction, int goal, const MapSnapshot &present_map, unsigned char my_id,
+                        MoveResolver &resolver);
+void add_move_candidates(int index, const SquarePlan &plan, const MapSnapshot &present_map, unsigned char my_id,
+                         const FlowField &flow, const TargetAssignment &assignment, MoveResolver &resolver);
+int get_planner_threads();
+//ForceSpeculation task: predicts the frame after the one in bot.snapshot and prepares its force sources
+void speculate_force_sources(ForceSpeculation &speculation, void *bot);
+
+//tables, if given, supplies map tables shared with other bots; the bot builds its own otherwise
+void init_bot(Bot &bot, unsigned char my_id, const hlt::GameMap &present_map, WorkerPool &pool, MapTableCache *tables = NULL);
+//Fills bot.directions for every square we own in bot.snapshot, which must already hold the new frame.
+//bot.deadline must have been started when the frame arrived, and the read phase already ended in bot.profiler.
+void plan_moves(Bot &bot);
+//Same for a frame held in a GameMap; the moves are left in bot.directions, indexed like bot.snapshot
+void plan_frame(Bot &bot, const hlt::GameMap &present_map);
+
+#endif
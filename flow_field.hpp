@@ -0,0 +1,101 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <algorithm>
+#include <vector>
+
+#include "map_snapshot.hpp"
+#include "territory.hpp"
+
+const int FLOW_VALUE_LEVELS = 8;
+
+//Next hop from each of our squares towards the border target that is cheapest to reach. Every border target is a
+//source whose starting cost is a penalty between 0 (as valuable as the best target) and FLOW_VALUE_LEVELS - 1 (close
+//to worthless), and each step through our territory costs 1. All steps cost the same, so a breadth-first search
+//that merges the sources in order of penalty is an exact shortest path, and a frame costs O(cells).
+struct FlowField
+{
+    std::vector<int> cost;//-1 where no route was found
+    std::vector<unsigned char> direction;//for our squares, STILL on the targets themselves
+    std::vector<int> target;
+    std::vector<int> sources;
+    std::vector<int> queue;
+};
+
+inline void init_flow_field(FlowField &flow, int cells)
+{
+    flow.cost.assign(cells, -1);
+    flow.direction.assign(cells, STILL);
+    flow.target.assign(cells, -1);
+    flow.sources.clear();
+    flow.sources.reserve(cells);
+    flow.queue.clear();
+    flow.queue.reserve(cells);
+}
+
+//Must run after update_territory, whose border and values are the sources
+inline void update_flow_field(FlowField &flow, const MapSnapshot &present_map, const Territory &territory, unsigned char my_id)
+{
+    std::fill(flow.cost.begin(), flow.cost.end(), -1);
+    flow.sources.clear();
+    flow.queue.clear();
+    if(territory.border.empty())
+    {
+        return;
+    }
+
+    float best_value = territory.value[territory.best_target()];
+    int level_count[FLOW_VALUE_LEVELS] = {0};
+    for(size_t i = 0; i < territory.border.size(); i++)
+    {
+        int index = territory.border[i];
+        int level = (best_value > 0.0) ? (int) (FLOW_VALUE_LEVELS * territory.value[index] / best_value) : 0;
+        int penalty = FLOW_VALUE_LEVELS - 1 - std::min(level, FLOW_VALUE_LEVELS - 1);
+        flow.cost[index] = penalty;
+        flow.direction[index] = STILL;
+        flow.target[index] = index;
+        level_count[penalty]++;
+    }
+    int position = 0;
+    for(int i = 0; i < FLOW_VALUE_LEVELS; i++)
+    {
+        int count = level_count[i];
+        level_count[i] = position;
+        position += count;
+    }
+    flow.sources.resize(position);
+    for(size_t i = 0; i < territory.border.size(); i++)
+    {
+        int index = territory.border[i];
+        flow.sources[level_count[flow.cost[index]]++] = index;
+    }
+
+    size_t next_source = 0;
+    size_t head = 0;
+    while((head < flow.queue.size()) || (next_source < flow.sources.size()))
+    {
+        int current;
+        if((next_source < flow.sources.size()) &&
+           ((head == flow.queue.size()) || (flow.cost[flow.sources[next_source]] <= flow.cost[flow.queue[head]])))
+        {
+            current = flow.sources[next_source++];
+        }
+        else
+        {
+            current = flow.queue[head++];
+        }
+        for(int i = 0; i < 4; i++)
+        {
+            int neighbor = present_map.neighbor(current, CARDINALS[i]);
+            if((present_map.owner[neighbor] == my_id) && (flow.cost[neighbor] == -1))
+            {
+                flow.cost[neighbor] = flow.cost[current] + 1;
+                flow.direction[neighbor] = OPPOSITE[CARDINALS[i]];
+                flow.target[neighbor] = flow.target[current];
+                flow.queue.push_back(neighbor);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef FORCE_FIELD_H
+#define FORCE_FIELD_H
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include "hlt.hpp"
+#include "offset_tables.hpp"
+
+//The force felt by a square is a sum over border sites of weight / dist^3 along the unit vector towards the site.
+//Each border site contributes five weights: one measured from the site itself and one from each of its neighbors
+//(see get_force_sources in bot.cpp). On a torus every term depends only on the wrapped offset, so the whole
+//field is five circular convolutions, evaluated here with a separable DFT in O(width * height * (width + height)).
+//Everything about the field that depends only on the map size: the DFT twiddles and the spectra of the five
+//kernels. Read-only once built, so every game on a map of the same size can share one (see map_tables.hpp).
+struct ForceKernels
+{
+    unsigned short width;
+    unsigned short height;
+    std::vector<std::complex<double> > row_twiddle;
+    std::vector<std::complex<double> > col_twiddle;
+    std::vector<std::complex<double> > kernel_spectrum[5];
+};
+
+struct ForceField
+{
+    const ForceKernels *kernels;
+    unsigned short width;
+    unsigned short height;
+    std::vector<std::complex<double> > source[5];
+    std::vector<std::complex<double> > field;
+    std::vector<std::complex<double> > scratch;
+    bool has_sources[5];
+    bool transformed[5];//source[d] already holds its spectrum times the kernel's
+};
+
+namespace force_field_detail
+{
+    inline void dft(std::vector<std::complex<double> > &data, std::vector<std::complex<double> > &scratch,
+                    const std::vector<std::complex<double> > &row_twiddle, const std::vector<std::complex<double> > &col_twiddle,
+                    int width, int height, bool inverse)
+    {
+        for(int y = 0; y < height; y++)
+        {
+            std::complex<double> *row = &data[y * width];
+            std::complex<double> *out = &scratch[y * width];
+            for(int u = 0; u < width; u++)
+            {
+                out[u] = 0.0;
+            }
+            for(int x = 0; x < width; x++)
+            {
+                if(row[x] == 0.0)
+                {
+                    continue;
+                }
+                int k = 0;
+                for(int u = 0; u < width; u++)
+                {
+                    out[u] += row[x] * (inverse ? std::conj(row_twiddle[k]) : row_twiddle[k]);
+                    k += x;
+                    if(k >= width)
+                    {
+                        k -= width;
+                    }
+                }
+            }
+        }
+        for(int i = 0; i < width * height; i++)
+        {
+            data[i] = 0.0;
+        }
+        for(int y = 0; y < height; y++)
+        {
+            const std::complex<double> *row = &scratch[y * width];
+            int k = 0;
+            for(int v = 0; v < height; v++)
+            {
+                std::complex<double> twiddle = inverse ? std::conj(col_twiddle[k]) : col_twiddle[k];
+                std::complex<double> *out = &data[v * width];
+                for(int u = 0; u < width; u++)
+                {
+                    out[u] += row[u] * twiddle;
+                }
+                k += y;
+                if(k >= height)
+                {
+                    k -= height;
+                }
+            }
+        }
+        if(inverse)
+        {
+            double scale = 1.0 / (width * height);
+            for(int i = 0; i < width * height; i++)
+            {
+                data[i] *= scale;
+            }
+        }
+    }
+}
+
+//The kernels come from the offset tables, so this is the only place their falloff and unit vectors are read
+inline void init_force_kernels(ForceKernels &kernels, const OffsetTables &offsets)
+{
+    unsigned short width = offsets.width;
+    unsigned short height = offsets.height;
+    const double PI = 3.14159265358979323846;
+    const int dx_of[5] = {0, 0, 1, 0, -1};//indexed by direction: STILL, NORTH, EAST, SOUTH, WEST
+    const int dy_of[5] = {0, -1, 0, 1, 0};
+    int cells = width * height;
+
+    kernels.width = width;
+    kernels.height = height;
+    kernels.row_twiddle.resize(width);
+    kernels.col_twiddle.resize(height);
+    for(int k = 0; k < width; k++)
+    {
+        kernels.row_twiddle[k] = std::polar(1.0, -2.0 * PI * k / width);
+    }
+    for(int k = 0; k < height; k++)
+    {
+        kernels.col_twiddle[k] = std::polar(1.0, -2.0 * PI * k / height);
+    }
+    std::vector<std::complex<double> > scratch(cells);
+
+    for(int d = 0; d < 5; d++)
+    {
+        //kernel[q] is the pull of a unit source at offset -q, so that the field is source (*) kernel
+        std::vector<std::complex<double> > &kernel = kernels.kernel_spectrum[d];
+        kernel.assign(cells, 0.0);
+        for(int y = 0; y < height; y++)
+        {
+            for(int x = 0; x < width; x++)
+            {
+                int ox = offsets.offset_x[x + width - 1];
+                int oy = offsets.offset_y[y + height - 1];
+                int dist = offsets.distance_x[ox + dx_of[d] + width - 1] + offsets.distance_y[oy + dy_of[d] + height - 1];
+                if(((ox == 0) && (oy == 0)) || (dist == 0))
+                {
+                    continue;
+                }
+                double ux = offsets.unit_x[y * width + x];
+                double uy = offsets.unit_y[y * width + x];
+                double falloff = offsets.falloff[dist];
+                int qx = (width - ox) % width;
+                int qy = (height - oy) % height;
+                kernel[qy * width + qx] = std::complex<double>(ux * falloff, uy * falloff);
+            }
+        }
+        force_field_detail::dft(kernel, scratch, kernels.row_twiddle, kernels.col_twiddle, width, height, false);
+    }
+}
+
+//kernels must outlive the field
+inline void init_force_field(ForceField &field, const ForceKernels &kernels)
+{
+    int cells = kernels.width * kernels.height;
+    field.kernels = &kernels;
+    field.width = kernels.width;
+    field.height = kernels.height;
+    field.field.assign(cells, 0.0);
+    field.scratch.assign(cells, 0.0);
+    for(int d = 0; d < 5; d++)
+    {
+        field.source[d].assign(cells, 0.0);
+        field.has_sources[d] = false;
+        field.transformed[d] = false;
+    }
+}
+
+inline void clear_force_sources(ForceField &field)
+{
+    for(int d = 0; d < 5; d++)
+    {
+        if(field.has_sources[d])
+        {
+            field.source[d].assign(field.source[d].size(), 0.0);
+            field.has_sources[d] = false;
+        }
+        field.transformed[d] = false;
+    }
+}
+
+//weight is measured from the neighbor of location in the given direction, but pulls towards location itself
+inline void add_force_source(ForceField &field, const hlt::Location &location, unsigned char direction, float weight)
+{
+    if(weight != 0.0)
+    {
+        field.source[direction][location.y * field.width + location.x] += weight;
+        field.has_sources[direction] = true;
+    }
+}
+
+//Replaces the sources in direction d by their spectrum times the kernel's; no more sources can be added to it after
+inline void transform_force_sources(ForceField &field, int d)
+{
+    const ForceKernels &kernels = *field.kernels;
+    int cells = field.width * field.height;
+    std::vector<std::complex<double> > &source = field.source[d];
+    force_field_detail::dft(source, field.scratch, kernels.row_twiddle, kernels.col_twiddle, field.width, field.height, false);
+    for(int i = 0; i < cells; i++)
+    {
+        source[i] *= kernels.kernel_spectrum[d][i];
+    }
+    field.transformed[d] = true;
+}
+
+//Directions already transformed (see reuse_speculative_sources in force_speculation.hpp) are not transformed again
+inline void compute_force_field(ForceField &field)
+{
+    const ForceKernels &kernels = *field.kernels;
+    int cells = field.width * field.height;
+    field.field.assign(cells, 0.0);
+    for(int d = 0; d < 5; d++)
+    {
+        if(!field.has_sources[d])
+        {
+            continue;
+        }
+        if(!field.transformed[d])
+        {
+            transform_force_sources(field, d);
+        }
+        for(int i = 0; i < cells; i++)
+        {
+            field.field[i] += field.source[d][i];
+        }
+    }
+    force_field_detail::dft(field.field, field.scratch, kernels.row_twiddle, kernels.col_twiddle, field.width, field.height, true);
+}
+
+inline void get_force(const ForceField &field, const hlt::Location &location, float &force_x, float &force_y)
+{
+    const std::complex<double> &force = field.field[location.y * field.width + location.x];
+    force_x = (float) force.real();
+    force_y = (float) force.imag();
+}
+
+#endif
@@ -0,0 +1,250 @@
+#ifndef FORCE_SPECULATION_H
+#define FORCE_SPECULATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "map_snapshot.hpp"
+#include "force_field.hpp"
+
+//Force sources of the next frame, built and transformed on a background thread while the environment steps the
+//other players. The next frame is predicted from the one just answered: our moves applied, production added to
+//the squares that stay, merges capped at 255, and every enemy holding still. Sources are kept as built, so when the
+//real frame arrives each direction whose real sources are equal to the predicted ones takes the transformed copy
+//instead of being transformed again, which gives bit-identical results. The rest of the frame is cheap and already
+//patched from the diff, so only the force field is speculated on.
+struct ForceSpeculation
+{
+    bool enabled;
+    MapSnapshot predicted;
+    std::vector<unsigned char> directions;//our moves for the frame predicted from
+    std::vector<int> arriving;//our strength moving into each square, -1 if none
+    ForceField field;
+    std::vector<std::complex<double> > sources[5];//field.source before it was transformed
+    bool ready[5];//field.source[d] is transformed and matches sources[d]
+    std::atomic<bool> built;//sources is complete, the task only transforms from here on
+    std::atomic<int> wanted;//bitmask of the directions the task still transforms
+
+    typedef void (*Task)(ForceSpeculation &speculation, void *context);
+
+    ForceSpeculation() : enabled(false), built(false), wanted(0), task(NULL), context(NULL), running(false), cancelled(false),
+                         stopping(false)
+    {
+    }
+
+    ~ForceSpeculation()
+    {
+        if(worker.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+                cancelled.store(true);
+            }
+            wake.notify_all();
+            worker.join();
+        }
+    }
+
+    //Runs task on the speculation thread; the caller must not touch the fields above until finish() returns
+    void start(Task task, void *context)
+    {
+        if(!worker.joinable())
+        {
+            worker = std::thread(&ForceSpeculation::work, this);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->task = task;
+            this->context = context;
+            cancelled.store(false);
+            running = true;
+        }
+        wake.notify_all();
+    }
+
+    //Asks a running task to stop at its next check and waits for it
+    void finish()
+    {
+        cancelled.store(true);
+        wait();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(running)
+        {
+            done.wait(lock);
+        }
+    }
+
+    bool is_cancelled() const
+    {
+        return cancelled.load();
+    }
+
+private:
+    ForceSpeculation(const ForceSpeculation &);
+    ForceSpeculation &operator=(const ForceSpeculation &);
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(true)
+        {
+            while(!stopping && !running)
+            {
+                wake.wait(lock);
+            }
+            if(stopping)
+            {
+                return;
+            }
+            lock.unlock();
+            task(*this, context);
+            lock.lock();
+            running = false;
+            done.notify_all();
+        }
+    }
+
+    Task task;
+    void *context;
+    bool running;
+    std::atomic<bool> cancelled;
+    bool stopping;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+};
+
+//Enables the speculation. Production is copied from present_map, which must already hold it; the thread starts with
+//the first speculation.
+inline void init_force_speculation(ForceSpeculation &speculation, const MapTables &tables, const MapSnapshot &present_map)
+{
+    speculation.enabled = true;
+    init_map_snapshot(speculation.predicted, tables);
+    speculation.predicted.production = present_map.production;
+    speculation.directions.assign(present_map.cells, 0);
+    speculation.arriving.assign(present_map.cells, -1);
+    init_force_field(speculation.field, tables.force_kernels);
+    for(int d = 0; d < 5; d++)
+    {
+        speculation.sources[d].assign(present_map.cells, 0.0);
+        speculation.ready[d] = false;
+    }
+}
+
+//Copies the frame just answered and our moves for it, then hands task to the speculation thread. A speculation
+//nobody used (the deadline passed before the force field) is cancelled first.
+inline void start_force_speculation(ForceSpeculation &speculation, const MapSnapshot &present_map,
+                                    const std::vector<unsigned char> &directions, ForceSpeculation::Task task, void *context)
+{
+    speculation.finish();
+    std::copy(present_map.owner.begin(), present_map.owner.end(), speculation.predicted.owner.begin());
+    std::copy(present_map.strength.begin(), present_map.strength.end(), speculation.predicted.strength.begin());
+    std::copy(directions.begin(), directions.end(), speculation.directions.begin());
+    for(int d = 0; d < 5; d++)
+    {
+        speculation.ready[d] = false;
+    }
+    speculation.built.store(false);
+    speculation.wanted.store((1 << 5) - 1);
+    speculation.start(task, context);
+}
+
+//Turns speculation.predicted from the frame just answered into the predicted next frame
+inline void predict_next_frame(ForceSpeculation &speculation, unsigned char my_id)
+{
+    MapSnapshot &map = speculation.predicted;
+    std::vector<int> &arriving = speculation.arriving;
+    std::fill(arriving.begin(), arriving.end(), -1);
+    for(int index = 0; index < map.cells; index++)
+    {
+        if(map.owner[index] == my_id)
+        {
+            unsigned char direction = speculation.directions[index];
+            int strength = map.strength[index] + ((direction == 0) ? map.production[index] : 0);
+            int target = map.neighbor(index, direction);
+            arriving[target] = std::min(255, std::max(arriving[target], 0) + strength);
+            map.strength[index] = 0;//a square we leave keeps an empty piece of ours
+        }
+        else if(map.owner[index] != 0)
+        {
+            map.strength[index] = std::min(255, map.strength[index] + map.production[index]);
+        }
+    }
+    for(int index = 0; index < map.cells; index++)
+    {
+        int strength = arriving[index];
+        if(strength < 0)
+        {
+            continue;
+        }
+        if(map.owner[index] == my_id)
+        {
+            map.strength[index] = strength;
+        }
+        else if(strength > map.strength[index])
+        {
+            map.owner[index] = my_id;
+            map.strength[index] = strength - map.strength[index];
+        }
+        else
+        {
+            map.strength[index] -= strength;
+        }
+    }
+}
+
+//Takes the transformed sources of every direction whose real sources came out the same as predicted, and returns
+//a bitmask of those directions. If the speculation got as far as building its sources, the directions that do not
+//match are transformed here while it finishes the ones that do; otherwise it is cancelled.
+inline int reuse_speculative_sources(ForceSpeculation &speculation, ForceField &field)
+{
+    if(!speculation.built.load())
+    {
+        speculation.finish();
+        return 0;
+    }
+    int cells = field.width * field.height;
+    int matching = 0;
+    for(int d = 0; d < 5; d++)
+    {
+        if(field.has_sources[d] && !field.transformed[d] &&
+           std::equal(field.source[d].begin(), field.source[d].begin() + cells, speculation.sources[d].begin()))
+        {
+            matching |= 1 << d;
+        }
+    }
+    speculation.wanted.store(matching);
+    for(int d = 0; d < 5; d++)
+    {
+        if(field.has_sources[d] && !field.transformed[d] && !(matching & (1 << d)))
+        {
+            transform_force_sources(field, d);
+        }
+    }
+    speculation.wait();
+    int reused = 0;
+    for(int d = 0; d < 5; d++)
+    {
+        if((matching & (1 << d)) && speculation.ready[d])
+        {
+            field.source[d].swap(speculation.field.source[d]);
+            field.transformed[d] = true;
+            speculation.ready[d] = false;
+            reused |= 1 << d;
+        }
+    }
+    return reused;
+}
+
+#endif
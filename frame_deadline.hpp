@@ -0,0 +1,43 @@
+#ifndef FRAME_DEADLINE_H
+#define FRAME_DEADLINE_H
+
+#include <chrono>
+#include <cstdlib>
+
+const int FRAME_BUDGET_MS = 1000;
+const int DEFAULT_SAFETY_MARGIN_MS = 150;
+
+//Wall-clock budget of one frame. start() should be called as soon as the frame is readable on stdin, before it is
+//parsed, so that every phase of the turn is charged against the environment's time limit.
+struct FrameDeadline
+{
+    std::chrono::steady_clock::time_point frame_start;
+    std::chrono::steady_clock::time_point deadline;
+    int margin_ms;
+
+    void start()
+    {
+        frame_start = std::chrono::steady_clock::now();
+        deadline = frame_start + std::chrono::milliseconds(FRAME_BUDGET_MS - margin_ms);
+    }
+
+    bool expired() const
+    {
+        return std::chrono::steady_clock::now() >= deadline;
+    }
+
+    double elapsed_ms() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count();
+    }
+};
+
+//BOT_SAFETY_MARGIN_MS overrides how long before the environment's limit we stop refining moves
+inline void init_frame_deadline(FrameDeadline &deadline)
+{
+    const char *margin = getenv("BOT_SAFETY_MARGIN_MS");
+    deadline.margin_ms = (margin != NULL) ? atoi(margin) : DEFAULT_SAFETY_MARGIN_MS;
+    deadline.start();
+}
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef FRAME_IO_H
+#define FRAME_IO_H
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "map_snapshot.hpp"
+
+//Frame input and move output without hlt::GameMap, std::stringstream or std::set<hlt::Move>. A frame is parsed
+//from one reused line buffer straight into the snapshot planes, and moves are formatted into one preallocated
+//buffer that goes out in a single write. Once the buffers have grown to the size of a frame nothing allocates.
+//Each FrameIO talks over its own pair of streams, so several games can run in one process.
+struct FrameIO
+{
+    std::istream *input;
+    std::ostream *output;
+    std::string line;
+    std::vector<unsigned char> owner;//owners of the frame being parsed, compared to the snapshot once strengths are in
+    std::vector<char> out;
+    int out_length;//bytes of out sent by the last write_moves
+};
+
+namespace frame_io_detail
+{
+    //Returns 0 once the line runs out, so a truncated frame leaves the rest of the map empty instead of reading past it
+    inline int parse_int(const char *&position)
+    {
+        while((*position == ' ') || (*position == '\r'))
+        {
+            position++;
+        }
+        int value = 0;
+        while((*position >= '0') && (*position <= '9'))
+        {
+            value = 10 * value + (*position - '0');
+            position++;
+        }
+        return value;
+    }
+
+    inline char *write_int(char *position, int value)
+    {
+        char digits[10];
+        int count = 0;
+        do
+        {
+            digits[count++] = '0' + value % 10;
+            value /= 10;
+        }
+        while(value != 0);
+        while(count != 0)
+        {
+            *position++ = digits[--count];
+        }
+        return position;
+    }
+}
+
+//Same result as getInit from networking.hpp, without its file-level state: the player tag, then the map size, the
+//productions and the first map. Returns false if in runs out first.
+inline bool read_init(std::istream &in, unsigned char &my_id, hlt::GameMap &present_map)
+{
+    std::string line;
+    if(!std::getline(in, line))
+    {
+        return false;
+    }
+    const char *position = line.c_str();
+    my_id = frame_io_detail::parse_int(position);
+    if(!std::getline(in, line))
+    {
+        return false;
+    }
+    position = line.c_str();
+    int width = frame_io_detail::parse_int(position);
+    int height = frame_io_detail::parse_int(position);
+    present_map = hlt::GameMap(width, height);
+    if(!std::getline(in, line))
+    {
+        return false;
+    }
+    position = line.c_str();
+    for(int y = 0; y < height; y++)
+    {
+        for(int x = 0; x < width; x++)
+        {
+            present_map.contents[y][x].production = frame_io_detail::parse_int(position);
+        }
+    }
+    if(!std::getline(in, line))
+    {
+        return false;
+    }
+    position = line.c_str();
+    int index = 0;
+    while(index < width * height)
+    {
+        int counter = frame_io_detail::parse_int(position);
+        unsigned char owner = frame_io_detail::parse_int(position);
+        if(counter == 0)
+        {
+            break;
+        }
+        for(int end = std::min(index + counter, width * height); index < end; index++)
+        {
+            present_map.contents[index / width][index % width].owner = owner;
+        }
+    }
+    for(index = 0; index < width * height; index++)
+    {
+        present_map.contents[index / width][index % width].strength = frame_io_detail::parse_int(position);
+    }
+    return true;
+}
+
+inline void init_frame_io(FrameIO &io, int cells, std::istream &in, std::ostream &out)
+{
+    io.input = &in;
+    io.output = &out;
+    io.line.reserve(16 * cells);
+    io.owner.assign(cells, 0);
+    io.out.resize(18 * cells + 1);//"x y d " with five digit coordinates, then the newline
+    io.out_length = 0;
+}
+
+//Same result as getFrame followed by update_map_snapshot: owner and strength planes updated, changed listing the
+//squares that differ in row-major order. Production never changes after init, so it is not part of a frame.
+inline bool read_frame(FrameIO &io, MapSnapshot &snapshot)
+{
+    if(!std::getline(*io.input, io.line))
+    {
+        return false;
+    }
+    const char *position = io.line.c_str();
+    int index = 0;
+    while(index < snapshot.cells)
+    {
+        int counter = frame_io_detail::parse_int(position);
+        unsigned char owner = frame_io_detail::parse_int(position);
+        if(counter == 0)
+        {
+            break;
+        }
+        for(int end = std::min(index + counter, snapshot.cells); index < end; index++)
+        {
+            io.owner[index] = owner;
+        }
+    }
+    for(; index < snapshot.cells; index++)
+    {
+        io.owner[index] = 0;
+    }
+
+    snapshot.changed.clear();
+    for(index = 0; index < snapshot.cells; index++)
+    {
+        unsigned char strength = frame_io_detail::parse_int(position);
+        if((snapshot.owner[index] != io.owner[index]) || (snapshot.strength[index] != strength))
+        {
+            snapshot.owner[index] = io.owner[index];
+            snapshot.strength[index] = strength;
+            snapshot.changed.push_back(index);
+        }
+    }
+    return true;
+}
+
+//One "x y direction" triple for every square my_id owns, in row-major order
+inline void write_moves(FrameIO &io, const MapSnapshot &snapshot, unsigned char my_id, const std::vector<unsigned char> &directions)
+{
+    char *position = &io.out[0];
+    for(int index = 0; index < snapshot.cells; index++)
+    {
+        if(snapshot.owner[index] == my_id)
+        {
+            position = frame_io_detail::write_int(position, index % snapshot.width);
+            *position++ = ' ';
+            position = frame_io_detail::write_int(position, index / snapshot.width);
+            *position++ = ' ';
+            *position++ = '0' + directions[index];
+            *position++ = ' ';
+        }
+    }
+    *position++ = '\n';
+    io.out_length = position - &io.out[0];
+    io.output->write(&io.out[0], io.out_length);
+    io.output->flush();
+}
+
+#endif
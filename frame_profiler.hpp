@@ -0,0 +1,207 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "frame_deadline.hpp"
+#include "trace_log.hpp"
+
+const int DEFAULT_PROFILE_MARGIN_MS = 300;
+const int HISTOGRAM_SUB_BITS = 3;//8 sub-buckets per power of two, so a bucket is at most 12.5% wide
+const int HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BITS;
+const int HISTOGRAM_BUCKETS = (32 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS;//nanoseconds, up to 2^32
+const int PROFILE_TERRITORIES = 4;
+const float PROFILE_TERRITORY_LIMITS[PROFILE_TERRITORIES - 1] = {0.05, 0.2, 0.5};//share of the map we own
+
+//Phases of a frame, in the order they run. A phase that did not run (the deadline passed first) gets no sample.
+enum FramePhase
+{
+    PHASE_READ,//parsing the frame into the snapshot
+    PHASE_PREPARE,//planes, territory and border targets, flow field
+    PHASE_FALLBACK,//cheap move for every square, kept if the deadline passes
+    PHASE_FORCE,//force field from the border targets
+    PHASE_PLAN,//per-square plans and the refine order
+    PHASE_CONTACT,//frontier simulation of the contact zones
+    PHASE_ASSIGN,//border target assignment
+    PHASE_CANDIDATES,//ranked move candidates of every square
+    PHASE_RESOLVE,//resolving the candidates against the caps
+    PHASE_WRITE,//sending the moves
+    PHASE_FRAME,//the whole frame, from the deadline's start to the end of the last phase
+    PHASE_COUNT
+};
+
+const char *const FRAME_PHASE_NAMES[PHASE_COUNT] = {"read", "prepare", "fallback", "force", "plan", "contact", "assign",
+                                                    "candidates", "resolve", "write", "frame"};
+
+//Per-phase latency histograms of the game, one set per territory share. Buckets are log-linear like HDR
+//histograms: exact below 16 ns, then 8 per power of two. Phases are timed into durations as they end and only
+//binned by end_profiled_frame, once the frame's territory is known. Frames that end within margin_ms of the
+//environment's limit are traced as TRACE_SLOW_FRAME and counted against their slowest phase.
+struct FrameProfiler
+{
+    int width;
+    int height;
+    int margin_ms;
+    std::chrono::steady_clock::time_point phase_start;
+    long long durations[PHASE_COUNT];//ns, -1 if the phase has not run this frame
+    std::vector<unsigned> counts;//[territory][phase][bucket]
+    std::vector<long long> max_ns;//[territory][phase]
+    std::vector<int> slow_frames;//[territory][phase]: slow frames where this phase took longest
+};
+
+namespace frame_profiler_detail
+{
+    inline int get_bucket(unsigned long long ns)
+    {
+        if(ns >= (1ULL << 32))
+        {
+            return HISTOGRAM_BUCKETS - 1;
+        }
+        if(ns < 2 * HISTOGRAM_SUB_BUCKETS)
+        {
+            return ns;
+        }
+        int exponent = 31 - __builtin_clz((unsigned) ns);
+        int shift = exponent - HISTOGRAM_SUB_BITS;
+        return (shift + 1) * HISTOGRAM_SUB_BUCKETS + ((ns >> shift) & (HISTOGRAM_SUB_BUCKETS - 1));
+    }
+
+    //Highest value that falls in bucket
+    inline long long get_bucket_limit(int bucket)
+    {
+        if(bucket < 2 * HISTOGRAM_SUB_BUCKETS)
+        {
+            return bucket;
+        }
+        int shift = bucket / HISTOGRAM_SUB_BUCKETS - 1;
+        long long first = (long long) (HISTOGRAM_SUB_BUCKETS + bucket % HISTOGRAM_SUB_BUCKETS) << shift;
+        return first + (1LL << shift) - 1;
+    }
+
+    inline int get_territory(int my_area, int cells)
+    {
+        int territory = 0;
+        while((territory < PROFILE_TERRITORIES - 1) && (my_area >= PROFILE_TERRITORY_LIMITS[territory] * cells))
+        {
+            territory++;
+        }
+        return territory;
+    }
+
+    inline long long get_percentile(const unsigned *counts, long long max_ns, unsigned frames, double percentile)
+    {
+        unsigned rank = (unsigned) (percentile * frames + 0.5);
+        unsigned seen = 0;
+        for(int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+        {
+            seen += counts[bucket];
+            if((seen >= rank) && (seen > 0))
+            {
+                return std::min(get_bucket_limit(bucket), max_ns);
+            }
+        }
+        return max_ns;
+    }
+}
+
+//BOT_PROFILE_MARGIN_MS overrides how close to the environment's limit a frame has to end to be reported
+inline void init_frame_profiler(FrameProfiler &profiler, int width, int height)
+{
+    const char *margin = getenv("BOT_PROFILE_MARGIN_MS");
+    profiler.width = width;
+    profiler.height = height;
+    profiler.margin_ms = (margin != NULL) ? atoi(margin) : DEFAULT_PROFILE_MARGIN_MS;
+    profiler.phase_start = std::chrono::steady_clock::now();
+    std::fill(profiler.durations, profiler.durations + PHASE_COUNT, -1LL);
+    profiler.counts.assign(PROFILE_TERRITORIES * PHASE_COUNT * HISTOGRAM_BUCKETS, 0);
+    profiler.max_ns.assign(PROFILE_TERRITORIES * PHASE_COUNT, 0);
+    profiler.slow_frames.assign(PROFILE_TERRITORIES * PHASE_COUNT, 0);
+}
+
+//The first phase is charged from the moment the deadline was started
+inline void start_profiled_frame(FrameProfiler &profiler, const FrameDeadline &deadline)
+{
+    profiler.phase_start = deadline.frame_start;
+    std::fill(profiler.durations, profiler.durations + PHASE_COUNT, -1LL);
+}
+
+//Ends phase now and starts the next one
+inline void end_phase(FrameProfiler &profiler, FramePhase phase)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    profiler.durations[phase] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - profiler.phase_start).count();
+    profiler.phase_start = now;
+}
+
+inline void end_profiled_frame(FrameProfiler &profiler, const FrameDeadline &deadline, int my_area, TraceLog &trace)
+{
+    profiler.durations[PHASE_FRAME] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - deadline.frame_start).count();
+    int territory = frame_profiler_detail::get_territory(my_area, profiler.width * profiler.height);
+    int slowest = PHASE_READ;
+    for(int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        long long ns = profiler.durations[phase];
+        if(ns < 0)
+        {
+            continue;
+        }
+        int histogram = territory * PHASE_COUNT + phase;
+        profiler.counts[histogram * HISTOGRAM_BUCKETS + frame_profiler_detail::get_bucket(ns)]++;
+        profiler.max_ns[histogram] = std::max(profiler.max_ns[histogram], ns);
+        if((phase != PHASE_FRAME) && (ns > profiler.durations[slowest]))
+        {
+            slowest = phase;
+        }
+    }
+    if(profiler.durations[PHASE_FRAME] >= (FRAME_BUDGET_MS - profiler.margin_ms) * 1000000LL)
+    {
+        profiler.slow_frames[territory * PHASE_COUNT + slowest]++;
+        profiler.slow_frames[territory * PHASE_COUNT + PHASE_FRAME]++;
+        trace.trace(TRACE_SLOW_FRAME, -1, slowest, 0, profiler.durations[PHASE_FRAME] / 1000);
+    }
+}
+
+//CSV, one line per territory share and phase that has samples:
+//width,height,territory,phase,frames,p50_us,p90_us,p99_us,max_us,slow_frames
+//territory is the lower bound of the share of the map we owned.
+inline bool write_frame_profile(const FrameProfiler &profiler, const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if(file == NULL)
+    {
+        return false;
+    }
+    fprintf(file, "width,height,territory,phase,frames,p50_us,p90_us,p99_us,max_us,slow_frames\n");
+    for(int territory = 0; territory < PROFILE_TERRITORIES; territory++)
+    {
+        for(int phase = 0; phase < PHASE_COUNT; phase++)
+        {
+            int histogram = territory * PHASE_COUNT + phase;
+            const unsigned *counts = &profiler.counts[histogram * HISTOGRAM_BUCKETS];
+            unsigned frames = 0;
+            for(int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+            {
+                frames += counts[bucket];
+            }
+            if(frames == 0)
+            {
+                continue;
+            }
+            long long max_ns = profiler.max_ns[histogram];
+            fprintf(file, "%d,%d,%.2f,%s,%u,%.1f,%.1f,%.1f,%.1f,%d\n", profiler.width, profiler.height,
+                    (territory == 0) ? 0.0 : PROFILE_TERRITORY_LIMITS[territory - 1], FRAME_PHASE_NAMES[phase], frames,
+                    frame_profiler_detail::get_percentile(counts, max_ns, frames, 0.5) / 1000.0,
+                    frame_profiler_detail::get_percentile(counts, max_ns, frames, 0.9) / 1000.0,
+                    frame_profiler_detail::get_percentile(counts, max_ns, frames, 0.99) / 1000.0,
+                    max_ns / 1000.0, profiler.slow_frames[histogram]);
+        }
+    }
+    return fclose(file) == 0;
+}
+
+#endif
@@ -0,0 +1,348 @@
+#ifndef FRONTIER_SIM_H
+#define FRONTIER_SIM_H
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "map_snapshot.hpp"
+
+const int ZONE_MAX_SQUARES = 6;
+const int ZONE_MAX_CELLS = 128;
+const int ZONE_MAX_CANDIDATES = 1024;
+const int ZONE_TURNS = 1;
+const int ZONE_PRODUCTION_WEIGHT = 8;//a square is worth its strength plus this many turns of its production
+const int ZONE_POLICIES = 2;//enemy squares all stay, or all attack
+
+enum ZoneOwner
+{
+    ZONE_NEUTRAL,
+    ZONE_US,
+    ZONE_ENEMY
+};
+
+//Owner and strength of every square of a zone, small enough to copy once per candidate
+struct ZoneState
+{
+    unsigned char owner[ZONE_MAX_CELLS];
+    unsigned char strength[ZONE_MAX_CELLS];
+};
+
+//One contact zone: a few of our border squares next to contested squares, and the window of squares within two steps
+//of them. Everything is a fixed-size array, so simulating a zone never allocates. All enemies are played
+//as one player, and squares outside the window are ignored.
+struct Zone
+{
+    int cells;
+    int global[ZONE_MAX_CELLS];
+    short neighbors[ZONE_MAX_CELLS][5];//-1 outside the window
+    unsigned char production[ZONE_MAX_CELLS];
+    ZoneState base;
+    int num_squares;
+    int squares[ZONE_MAX_SQUARES];//local index of the squares we choose moves for
+    int num_options[ZONE_MAX_SQUARES];
+    unsigned char options[ZONE_MAX_SQUARES][5];
+    short pieces[2][ZONE_MAX_CELLS];//strength after moving, -1 if none
+    short injury[2][ZONE_MAX_CELLS];//-1 if nothing attacks the piece
+    short neutral_damage[ZONE_MAX_CELLS];
+};
+
+struct FrontierSim
+{
+    std::vector<short> local;//global index -> index in the zone being built, -1 elsewhere
+    std::vector<unsigned char> contact;
+    std::vector<unsigned char> assigned;
+    std::vector<int> contacts;//scratch for the planner, reserved once
+    std::vector<int> group;
+    Zone zone;
+};
+
+inline void init_frontier_sim(FrontierSim &sim, int cells)
+{
+    sim.local.assign(cells, -1);
+    sim.contact.assign(cells, 0);
+    sim.assigned.assign(cells, 0);
+    sim.contacts.clear();
+    sim.contacts.reserve(cells);
+    sim.group.clear();
+    sim.group.reserve(ZONE_MAX_SQUARES);
+}
+
+namespace frontier_sim_detail
+{
+    inline void add_cell(FrontierSim &sim, const MapSnapshot &present_map, unsigned char my_id, int index)
+    {
+        Zone &zone = sim.zone;
+        if((sim.local[index] != -1) || (zone.cells == ZONE_MAX_CELLS))
+        {
+            return;
+        }
+        sim.local[index] = zone.cells;
+        zone.global[zone.cells] = index;
+        zone.production[zone.cells] = present_map.production[index];
+        unsigned char owner = present_map.owner[index];
+        zone.base.owner[zone.cells] = (owner == 0) ? ZONE_NEUTRAL : ((owner == my_id) ? ZONE_US : ZONE_ENEMY);
+        zone.base.strength[zone.cells] = present_map.strength[index];
+        zone.cells++;
+    }
+
+    //Direction for each enemy square under the given policy: stay, or move into the neighbor where it can hurt most
+    //of our strength
+    inline void get_enemy_moves(const Zone &zone, const ZoneState &state, int policy, unsigned char *directions)
+    {
+        for(int c = 0; c < zone.cells; c++)
+        {
+            directions[c] = STILL;
+            if((policy == 0) || (state.owner[c] != ZONE_ENEMY) || (state.strength[c] == 0))
+            {
+                continue;
+            }
+            int best_damage = 0;
+            for(int i = 0; i < 4; i++)
+            {
+                int n = zone.neighbors[c][CARDINALS[i]];
+                if((n == -1) || (state.owner[n] == ZONE_ENEMY))
+                {
+                    continue;
+                }
+                int damage = 0;
+                for(int d = 0; d < 5; d++)
+                {
+                    int m = zone.neighbors[n][d];
+                    if((m != -1) && (state.owner[m] == ZONE_US))
+                    {
+                        damage += state.strength[m];
+                    }
+                }
+                if(damage > best_damage)
+                {
+                    best_damage = damage;
+                    directions[c] = CARDINALS[i];
+                }
+            }
+        }
+    }
+
+    //One turn of the 2016 rules restricted to the window: production, moves merged and capped at 255, damage to
+    //enemy pieces on and next to a square, neutral squares fighting only what is on them
+    inline void play_turn(Zone &zone, ZoneState &state, const unsigned char *our_moves, const unsigned char *enemy_moves)
+    {
+        for(int c = 0; c < zone.cells; c++)
+        {
+            zone.pieces[0][c] = zone.pieces[1][c] = -1;
+            zone.injury[0][c] = zone.injury[1][c] = -1;
+            zone.neutral_damage[c] = 0;
+        }
+        for(int c = 0; c < zone.cells; c++)
+        {
+            if(state.owner[c] == ZONE_NEUTRAL)
+            {
+                continue;
+            }
+            int p = state.owner[c] - 1;
+            unsigned char direction = (p == 0) ? our_moves[c] : enemy_moves[c];
+            int strength = state.strength[c];
+            if(direction == STILL)
+            {
+                strength = std::min(255, strength + zone.production[c]);
+            }
+            int target = zone.neighbors[c][direction];
+            if(target != -1)//pieces leaving the window are dropped
+            {
+                short &piece = zone.pieces[p][target];
+                piece = (piece == -1) ? strength : std::min(255, piece + strength);
+            }
+            if(zone.pieces[p][c] == -1)
+            {
+                zone.pieces[p][c] = 0;
+            }
+            state.owner[c] = ZONE_NEUTRAL;
+            state.strength[c] = 0;
+        }
+        for(int c = 0; c < zone.cells; c++)
+        {
+            for(int p = 0; p < 2; p++)
+            {
+                int strength = zone.pieces[p][c];
+                if(strength == -1)
+                {
+                    continue;
+                }
+                for(int d = 0; d < 5; d++)
+                {
+                    int n = zone.neighbors[c][d];
+                    if((n != -1) && (zone.pieces[1 - p][n] != -1))
+                    {
+                        zone.injury[1 - p][n] = std::max<short>(zone.injury[1 - p][n], 0) + strength;
+                    }
+                }
+                if(state.strength[c] > 0)
+                {
+                    zone.injury[p][c] = std::max<short>(zone.injury[p][c], 0) + state.strength[c];
+                    zone.neutral_damage[c] += strength;
+                }
+            }
+        }
+        for(int c = 0; c < zone.cells; c++)
+        {
+            state.strength[c] = std::max(0, state.strength[c] - zone.neutral_damage[c]);
+            for(int p = 0; p < 2; p++)
+            {
+                short &piece = zone.pieces[p][c];
+                if((piece != -1) && (zone.injury[p][c] != -1))
+                {
+                    piece = (zone.injury[p][c] >= piece) ? -1 : piece - zone.injury[p][c];
+                }
+                if(piece != -1)
+                {
+                    state.owner[c] = p + 1;
+                    state.strength[c] = piece;
+                }
+            }
+        }
+    }
+
+    inline int score(const Zone &zone, const ZoneState &state)
+    {
+        int total = 0;
+        for(int c = 0; c < zone.cells; c++)
+        {
+            int worth = state.strength[c] + ZONE_PRODUCTION_WEIGHT * zone.production[c];
+            if(state.owner[c] == ZONE_US)
+            {
+                total += worth;
+            }
+            else if(state.owner[c] == ZONE_ENEMY)
+            {
+                total -= worth;
+            }
+        }
+        return total;
+    }
+
+    //Worst score over the enemy policies of playing our_moves, then ZONE_TURNS - 1 turns of waiting
+    inline int evaluate(Zone &zone, const unsigned char *our_moves)
+    {
+        unsigned char still[ZONE_MAX_CELLS] = {0};
+        unsigned char enemy_moves[ZONE_MAX_CELLS];
+        int worst = 0;
+        for(int policy = 0; policy < ZONE_POLICIES; policy++)
+        {
+            ZoneState state = zone.base;
+            for(int turn = 0; turn < ZONE_TURNS; turn++)
+            {
+                get_enemy_moves(zone, state, policy, enemy_moves);
+                play_turn(zone, state, (turn == 0) ? our_moves : still, enemy_moves);
+            }
+            int value = score(zone, state);
+            if((policy == 0) || (value < worst))
+            {
+                worst = value;
+            }
+        }
+        return worst;
+    }
+}
+
+//Squares we do not own that an enemy owns or touches: moving there can start a fight
+inline bool is_contested(int index, const MapSnapshot &present_map, unsigned char my_id)
+{
+    if(present_map.owner[index] != 0)
+    {
+        return present_map.owner[index] != my_id;
+    }
+    if(present_map.planes.enemy_pressure[index] > 0)
+    {
+        return true;
+    }
+    for(int i = 0; i < 4; i++)
+    {
+        int n = present_map.neighbor(index, CARDINALS[i]);
+        if((present_map.owner[n] != 0) && (present_map.owner[n] != my_id))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//Simulates every combination of moves (each square waits or moves into one of its contested targets, ties going to
+//waiting and then to the order given) for the squares in group and writes the best one to directions. group holds at most ZONE_MAX_SQUARES squares.
+inline void solve_zone(FrontierSim &sim, const MapSnapshot &present_map, unsigned char my_id, const std::vector<int> &group,
+                       const unsigned char targets[][4], const unsigned char *num_targets, unsigned char *directions)
+{
+    Zone &zone = sim.zone;
+    zone.cells = 0;
+    zone.num_squares = group.size();
+    for(int s = 0; s < zone.num_squares; s++)
+    {
+        frontier_sim_detail::add_cell(sim, present_map, my_id, group[s]);
+    }
+    for(int s = 0; s < zone.num_squares; s++)
+    {
+        for(int d1 = 0; d1 < 5; d1++)
+        {
+            int n = present_map.neighbor(group[s], DIRECTIONS[d1]);
+            for(int d2 = 0; d2 < 5; d2++)
+            {
+                frontier_sim_detail::add_cell(sim, present_map, my_id, present_map.neighbor(n, DIRECTIONS[d2]));
+            }
+        }
+    }
+    for(int c = 0; c < zone.cells; c++)
+    {
+        for(int d = 0; d < 5; d++)
+        {
+            zone.neighbors[c][d] = sim.local[present_map.neighbor(zone.global[c], d)];
+        }
+    }
+
+    int candidates = 1;
+    for(int s = 0; s < zone.num_squares; s++)
+    {
+        zone.squares[s] = sim.local[group[s]];
+        zone.options[s][0] = STILL;//first, so that moving has to be strictly better than waiting
+        zone.num_options[s] = 1;
+        for(int i = 0; i < num_targets[s]; i++)
+        {
+            zone.options[s][zone.num_options[s]++] = targets[s][i];
+        }
+        candidates *= zone.num_options[s];
+    }
+
+    unsigned char moves[ZONE_MAX_CELLS] = {0};
+    int choice[ZONE_MAX_SQUARES] = {0};
+    int best_choice[ZONE_MAX_SQUARES] = {0};
+    int best_value = 0;
+    for(int k = 0; k < std::min(candidates, ZONE_MAX_CANDIDATES); k++)
+    {
+        for(int s = 0; s < zone.num_squares; s++)
+        {
+            moves[zone.squares[s]] = zone.options[s][choice[s]];
+        }
+        int value = frontier_sim_detail::evaluate(zone, moves);
+        if((k == 0) || (value > best_value))
+        {
+            best_value = value;
+            std::copy(choice, choice + zone.num_squares, best_choice);
+        }
+        for(int s = zone.num_squares - 1; s >= 0; s--)//next combination, the last square changing fastest
+        {
+            if(++choice[s] < zone.num_options[s])
+            {
+                break;
+            }
+            choice[s] = 0;
+        }
+    }
+    for(int s = 0; s < zone.num_squares; s++)
+    {
+        directions[s] = zone.options[s][best_choice[s]];
+    }
+    for(int c = 0; c < zone.cells; c++)
+    {
+        sim.local[zone.global[c]] = -1;
+    }
+}
+
+#endif
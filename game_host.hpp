@@ -0,0 +1,254 @@
+#ifndef GAME_HOST_H
+#define GAME_HOST_H
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "game_session.hpp"
+#include "memory_footprint.hpp"
+
+const int SOCKET_BUFFER_SIZE = 1 << 16;
+const int HOST_GAMES_PER_THREAD = 4;//games mostly wait for the environment, so each hardware thread serves several
+
+//Stream buffer over a connected socket, so a session reads and writes it like std::cin and std::cout.
+//Writes use MSG_NOSIGNAL: a game whose environment went away ends with a failed stream, not a SIGPIPE.
+class SocketStreambuf : public std::streambuf
+{
+public:
+    explicit SocketStreambuf(int socket) : socket(socket), input(SOCKET_BUFFER_SIZE), output(SOCKET_BUFFER_SIZE)
+    {
+        setg(&input[0], &input[0], &input[0]);
+        setp(&output[0], &output[0] + output.size());
+    }
+
+protected:
+    int_type underflow()
+    {
+        ssize_t received;
+        do
+        {
+            received = recv(socket, &input[0], input.size(), 0);
+        }
+        while((received < 0) && (errno == EINTR));
+        if(received <= 0)
+        {
+            return traits_type::eof();
+        }
+        setg(&input[0], &input[0], &input[0] + received);
+        return traits_type::to_int_type(input[0]);
+    }
+
+    int_type overflow(int_type c)
+    {
+        if(!send_output())
+        {
+            return traits_type::eof();
+        }
+        if(!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync()
+    {
+        return send_output() ? 0 : -1;
+    }
+
+private:
+    bool send_output()
+    {
+        const char *position = pbase();
+        while(position < pptr())
+        {
+            ssize_t sent = send(socket, position, pptr() - position, MSG_NOSIGNAL);
+            if(sent < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            position += sent;
+        }
+        setp(&output[0], &output[0] + output.size());
+        return true;
+    }
+
+    int socket;
+    std::vector<char> input;
+    std::vector<char> output;
+};
+
+//Many games in one process: every connection accepted on the host's Unix domain socket is one game speaking the
+//usual protocol. Game threads take connections in the order they arrive and play each to the end on a planner
+//pool of their own, so games never wait on each other's planning; only the map tables are shared.
+struct GameHost
+{
+    MapTableCache tables;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<int> connections;
+    int games;//games started so far, the number of the next one
+    bool stopping;
+    const char *trace_path;//BOT_TRACE and BOT_PROFILE get ".<game number>" appended, one file per game
+    const char *profile_path;
+    bool speculate;//off unless BOT_SPECULATE=1: the other games already keep the cores busy
+    bool fixed_memory;//BOT_FIXED_MEMORY reports the peak RSS after each game; frames are not checked, games overlap
+};
+
+namespace game_host_detail
+{
+    inline void play_connection(GameHost &host, int connection, int game)
+    {
+        SocketStreambuf buffer(connection);
+        std::istream in(&buffer);
+        std::ostream out(&buffer);
+        WorkerPool pool(1);
+        GameSession session;
+        char suffix[16];
+        snprintf(suffix, sizeof(suffix), ".%d", game);
+        if((host.trace_path != NULL) && !session.bot.trace.open((host.trace_path + std::string(suffix)).c_str()))
+        {
+            std::cerr << "cannot write trace " << host.trace_path << suffix << std::endl;
+        }
+        std::string profile_path = (host.profile_path != NULL) ? host.profile_path + std::string(suffix) : "";
+        if(start_game_session(session, in, out, pool, host.speculate, &host.tables))
+        {
+            while(play_game_frame(session))
+            {
+                if(!profile_path.empty() && !write_frame_profile(session.bot.profiler, profile_path.c_str()))
+                {
+                    std::cerr << "cannot write profile " << profile_path << std::endl;
+                    profile_path.clear();
+                }
+            }
+            if(host.fixed_memory)
+            {
+                std::ostringstream report;//one write, so reports of games ending together do not interleave
+                report << "game " << game << ": peak RSS " << get_peak_rss_kb() << " kB, whole process\n";
+                std::cerr << report.str() << std::flush;
+            }
+        }
+        session.bot.trace.close();
+        close(connection);
+    }
+
+    inline void serve(GameHost &host)
+    {
+        while(true)
+        {
+            int connection;
+            int game;
+            {
+                std::unique_lock<std::mutex> lock(host.mutex);
+                while(!host.stopping && host.connections.empty())
+                {
+                    host.ready.wait(lock);
+                }
+                if(host.connections.empty())
+                {
+                    return;
+                }
+                connection = host.connections.front();
+                host.connections.pop_front();
+                game = host.games++;
+            }
+            play_connection(host, connection, game);
+        }
+    }
+}
+
+//Serves games on the socket at path until accepting fails, then plays the games still queued and returns false.
+//threads is how many games are played at once, 0 for HOST_GAMES_PER_THREAD per hardware thread.
+inline bool run_game_host(const char *path, int threads)
+{
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(address.sun_path))
+    {
+        std::cerr << "socket path too long " << path << std::endl;
+        return false;
+    }
+    strcpy(address.sun_path, path);
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if((listener < 0) || (bind(listener, (sockaddr *) &address, sizeof(address)) != 0) || (listen(listener, SOMAXCONN) != 0))
+    {
+        std::cerr << "cannot listen on " << path << ": " << strerror(errno) << std::endl;
+        if(listener >= 0)
+        {
+            close(listener);
+        }
+        return false;
+    }
+    if(threads <= 0)
+    {
+        threads = HOST_GAMES_PER_THREAD * std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    GameHost host;
+    host.games = 0;
+    host.stopping = false;
+    host.trace_path = getenv("BOT_TRACE");
+    host.profile_path = getenv("BOT_PROFILE");
+    const char *speculate = getenv("BOT_SPECULATE");
+    host.speculate = (speculate != NULL) && (atoi(speculate) != 0);
+    const char *fixed_memory = getenv("BOT_FIXED_MEMORY");
+    host.fixed_memory = (fixed_memory != NULL) && (atoi(fixed_memory) != 0);
+    std::vector<std::thread> servers;
+    for(int i = 0; i < threads; i++)
+    {
+        servers.push_back(std::thread(game_host_detail::serve, std::ref(host)));
+    }
+    while(true)
+    {
+        int connection = accept(listener, NULL, NULL);
+        if(connection < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            std::cerr << "accept failed: " << strerror(errno) << std::endl;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(host.mutex);
+        host.connections.push_back(connection);
+        host.ready.notify_one();
+    }
+    {
+        std::lock_guard<std::mutex> lock(host.mutex);
+        host.stopping = true;
+    }
+    host.ready.notify_all();
+    for(size_t i = 0; i < servers.size(); i++)
+    {
+        servers[i].join();
+    }
+    close(listener);
+    unlink(path);
+    return false;
+}
+
+#endif
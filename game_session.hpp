@@ -0,0 +1,64 @@
+#ifndef GAME_SESSION_H
+#define GAME_SESSION_H
+
+#include <iostream>
+
+#include "bot.hpp"
+#include "frame_io.hpp"
+
+const char BOT_NAME[] = "my_c++_bot_v27_test";
+
+//One game over one pair of streams, from the init message to the last frame. Everything the game needs lives in
+//here or in the MapTables it shares read-only (the planner never calls rand), so a process can play any number of
+//sessions at once as long as each has its own streams and worker pool.
+struct GameSession
+{
+    Bot bot;
+    FrameIO io;
+};
+
+//Reads the init message, sets the bot up and answers with its name. Returns false if in runs out first.
+//speculate runs a ForceSpeculation for the next frame while waiting for it, on one more thread.
+inline bool start_game_session(GameSession &session, std::istream &in, std::ostream &out, WorkerPool &pool,
+                               bool speculate, MapTableCache *tables = NULL)
+{
+    unsigned char my_id;
+    hlt::GameMap present_map;
+    if(!read_init(in, my_id, present_map))
+    {
+        return false;
+    }
+    init_bot(session.bot, my_id, present_map, pool, tables);
+    if(speculate)
+    {
+        init_force_speculation(session.bot.speculation, *session.bot.tables, session.bot.snapshot);
+    }
+    init_frame_io(session.io, session.bot.snapshot.cells, in, out);
+    out << BOT_NAME << std::endl;
+    return true;
+}
+
+//Waits for the next frame and answers it. Returns false once the environment stops sending frames.
+inline bool play_game_frame(GameSession &session)
+{
+    Bot &bot = session.bot;
+    session.io.input->peek();//blocks until the environment starts sending the frame
+    bot.deadline.start();
+    start_profiled_frame(bot.profiler, bot.deadline);
+    if(!read_frame(session.io, bot.snapshot))
+    {
+        return false;
+    }
+    end_phase(bot.profiler, PHASE_READ);
+    plan_moves(bot);
+    write_moves(session.io, bot.snapshot, bot.my_id, bot.directions);
+    end_phase(bot.profiler, PHASE_WRITE);
+    end_profiled_frame(bot.profiler, bot.deadline, bot.territory.my_area, bot.trace);
+    if(bot.speculation.enabled)
+    {
+        start_force_speculation(bot.speculation, bot.snapshot, bot.directions, speculate_force_sources, &bot);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef MAP_SNAPSHOT_H
+#define MAP_SNAPSHOT_H
+
+#include <vector>
+
+#include "hlt.hpp"
+#include "map_tables.hpp"
+#include "stencil_planes.hpp"
+
+const unsigned char OPPOSITE[5] = {STILL, SOUTH, WEST, NORTH, EAST};//the direction that steps back
+
+//Flat copy of the current frame. Squares are addressed by index = y * width + x and every plane is one byte per
+//square, so the heuristics can take it by const reference and walk it without touching hlt::GameMap.
+//The planes are sized once in init_map_snapshot; update_map_snapshot never allocates. The neighbor and offset
+//tables are read through pointers into MapTables that may be shared with other games.
+//changed lists the squares whose owner, strength or production differ from the previous frame.
+struct MapSnapshot
+{
+    unsigned short width;
+    unsigned short height;
+    int cells;
+    std::vector<unsigned char> owner;
+    std::vector<unsigned char> strength;
+    std::vector<unsigned char> production;
+    const int *neighbors;//see MapTables
+    std::vector<int> changed;
+    StencilPlanes planes;//derived planes for the player given to update_snapshot_planes
+    const OffsetTables *offsets;
+
+    int index(const hlt::Location &location) const
+    {
+        return location.y * width + location.x;
+    }
+
+    hlt::Location location(int index) const
+    {
+        hlt::Location location = {offsets->column[index], offsets->row[index]};
+        return location;
+    }
+
+    int neighbor(int index, unsigned char direction) const
+    {
+        return neighbors[5 * index + direction];
+    }
+
+    hlt::Site site(int index) const
+    {
+        hlt::Site site = {owner[index], strength[index], production[index]};
+        return site;
+    }
+
+    //Same wrapped Manhattan distance as hlt::GameMap::getDistance
+    float distance(int first, int second) const
+    {
+        return offsets->distance(first, second);
+    }
+};
+
+//tables must outlive the snapshot
+inline void init_map_snapshot(MapSnapshot &snapshot, const MapTables &tables)
+{
+    unsigned short width = tables.offsets.width;
+    unsigned short height = tables.offsets.height;
+    snapshot.width = width;
+    snapshot.height = height;
+    snapshot.cells = width * height;
+    snapshot.owner.assign(snapshot.cells, 0);
+    snapshot.strength.assign(snapshot.cells, 0);
+    snapshot.production.assign(snapshot.cells, 0);
+    snapshot.neighbors = &tables.neighbors[0];
+    snapshot.offsets = &tables.offsets;
+    snapshot.changed.clear();
+    snapshot.changed.reserve(snapshot.cells);
+    init_stencil_planes(snapshot.planes, width, height);
+}
+
+//Too weak to be worth moving: a square this weak gains more by staying and producing
+inline bool is_weak(int index, const MapSnapshot &present_map)
+{
+    return present_map.strength[index] < 5 * present_map.production[index];
+}
+
+inline void update_map_snapshot(MapSnapshot &snapshot, const hlt::GameMap &present_map)
+{
+    snapshot.changed.clear();
+    for(int y = 0; y < snapshot.height; y++)
+    {
+        const hlt::Site *row = &present_map.contents[y][0];
+        int base = y * snapshot.width;
+        for(int x = 0; x < snapshot.width; x++)
+        {
+            if((snapshot.owner[base + x] != row[x].owner) || (snapshot.strength[base + x] != row[x].strength) ||
+               (snapshot.production[base + x] != row[x].production))
+            {
+                snapshot.owner[base + x] = row[x].owner;
+                snapshot.strength[base + x] = row[x].strength;
+                snapshot.production[base + x] = row[x].production;
+                snapshot.changed.push_back(base + x);
+            }
+        }
+    }
+}
+
+inline void update_snapshot_planes(MapSnapshot &snapshot, unsigned char my_id)
+{
+    update_stencil_planes(snapshot.planes, &snapshot.owner[0], &snapshot.strength[0], &snapshot.production[0],
+                          snapshot.width, snapshot.height, my_id);
+}
+
+#endif
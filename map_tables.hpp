@@ -0,0 +1,71 @@
+#ifndef MAP_TABLES_H
+#define MAP_TABLES_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "hlt.hpp"
+#include "offset_tables.hpp"
+#include "force_field.hpp"
+
+//Lookups that depend only on the map size. They never change after init_map_tables, so every game on a map of
+//that size can read the same copy, from any thread.
+//  neighbors: neighbors[5 * index + direction], with direction STILL mapping to index itself
+struct MapTables
+{
+    std::vector<int> neighbors;
+    OffsetTables offsets;
+    ForceKernels force_kernels;
+};
+
+inline void init_map_tables(MapTables &tables, unsigned short width, unsigned short height)
+{
+    tables.neighbors.resize(5 * width * height);
+    for(int y = 0; y < height; y++)
+    {
+        for(int x = 0; x < width; x++)
+        {
+            int *entry = &tables.neighbors[5 * (y * width + x)];
+            entry[STILL] = y * width + x;
+            entry[NORTH] = ((y == 0) ? (height - 1) : (y - 1)) * width + x;
+            entry[EAST] = y * width + ((x == width - 1) ? 0 : (x + 1));
+            entry[SOUTH] = ((y == height - 1) ? 0 : (y + 1)) * width + x;
+            entry[WEST] = y * width + ((x == 0) ? (width - 1) : (x - 1));
+        }
+    }
+    init_offset_tables(tables.offsets, width, height);
+    init_force_kernels(tables.force_kernels, tables.offsets);
+}
+
+inline std::shared_ptr<const MapTables> make_map_tables(unsigned short width, unsigned short height)
+{
+    std::shared_ptr<MapTables> tables = std::make_shared<MapTables>();
+    init_map_tables(*tables, width, height);
+    return tables;
+}
+
+//Tables of every map size seen so far, kept until the cache goes. Tables are built under the lock, so games that
+//start on a new size at the same time build it once.
+class MapTableCache
+{
+public:
+    std::shared_ptr<const MapTables> get(unsigned short width, unsigned short height)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::shared_ptr<const MapTables> &tables = cache[std::make_pair(width, height)];
+        if(!tables)
+        {
+            tables = make_map_tables(width, height);
+        }
+        return tables;
+    }
+
+private:
+    std::mutex mutex;
+    std::map<std::pair<unsigned short, unsigned short>, std::shared_ptr<const MapTables> > cache;
+};
+
+#endif
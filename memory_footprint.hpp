@@ -0,0 +1,98 @@
+#ifndef MEMORY_FOOTPRINT_H
+#define MEMORY_FOOTPRINT_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+
+#include <sys/resource.h>
+
+#include "trace_log.hpp"
+
+const int FIXED_MEMORY_WARMUP_FRAMES = 1;//the first frame starts the speculation thread
+
+//Whether the program's operator new counts, as MyBot.cpp's does under BOT_FIXED_MEMORY. Set once before any other
+//thread starts and only read after, so it is a plain bool and an uncounted allocation costs one predictable branch.
+inline bool &get_allocation_counting()
+{
+    static bool counting = false;
+    return counting;
+}
+
+//Every operator new in the process while counting, worker threads included. Stays 0 otherwise.
+inline std::atomic<long long> &get_allocation_count()
+{
+    static std::atomic<long long> count(0);
+    return count;
+}
+
+//Checks that a game runs in the memory it set up at init. Everything a frame needs is sized from the map in the
+//init_* functions and only refilled afterwards, so once the warmup frames are over every frame (and whatever the
+//speculation thread does between frames) should leave the allocation count where it was. Frames that allocate are
+//traced as TRACE_ALLOCATION and reported once on stderr; DEBUG builds abort on them like a failed assert.
+//Only operator new is counted: the C stdio buffers behind BOT_PROFILE and BOT_RECORD are not.
+struct MemoryFootprint
+{
+    bool checked;//false to only report the peak RSS
+    int frames;
+    int allocating_frames;
+    long long allocations;//after the warmup frames
+    long long last_count;
+};
+
+//Call once the game is set up, so that its init allocations do not count
+inline void init_memory_footprint(MemoryFootprint &memory, bool checked)
+{
+    memory.checked = checked;
+    memory.frames = 0;
+    memory.allocating_frames = 0;
+    memory.allocations = 0;
+    memory.last_count = get_allocation_count().load();
+}
+
+//Call after each frame is answered; the allocations since the previous call are charged to it
+inline void end_memory_frame(MemoryFootprint &memory, TraceLog &trace)
+{
+    long long count = get_allocation_count().load();
+    long long allocated = count - memory.last_count;
+    memory.last_count = count;
+    memory.frames++;
+    if(!memory.checked || (memory.frames <= FIXED_MEMORY_WARMUP_FRAMES) || (allocated == 0))
+    {
+        return;
+    }
+    trace.trace(TRACE_ALLOCATION, -1, -1, 0, allocated);
+    if(memory.allocating_frames++ == 0)
+    {
+        std::cerr << "frame " << memory.frames - 1 << " allocated " << allocated << " times" << std::endl;
+    }
+    memory.allocations += allocated;
+    #ifdef DEBUG
+        abort();
+    #endif // DEBUG
+}
+
+//Peak resident set size of the whole process
+inline long get_peak_rss_kb()
+{
+    rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return -1;
+    }
+    return usage.ru_maxrss;//kilobytes on Linux
+}
+
+inline void report_memory_footprint(const MemoryFootprint &memory, std::ostream &out)
+{
+    out << "peak RSS " << get_peak_rss_kb() << " kB";
+    if(memory.checked)
+    {
+        out << ", " << memory.allocations << " allocations in " << memory.allocating_frames << " of "
+            << std::max(0, memory.frames - FIXED_MEMORY_WARMUP_FRAMES) << " frames after the warmup";
+    }
+    out << std::endl;
+}
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef MOVE_RESOLVER_H
+#define MOVE_RESOLVER_H
+
+#include <algorithm>
+#include <vector>
+
+#include "map_snapshot.hpp"
+#include "trace_log.hpp"
+
+const int STRENGTH_CAP = 255;//strength above this is lost when squares merge
+const int CAP_BOUND = 265;
+const int MAX_MOVE_CANDIDATES = 6;//contact capture, four target captures and a step; STILL always comes after them
+
+//One move a square would make, in the order it prefers them
+struct MoveCandidate
+{
+    unsigned char direction;
+    unsigned char event;//TraceEvent logged if this is the move it gets
+    short cap;//the move is taken only while the strength sent into the square there stays below this
+    int goal;//traced with event
+};
+
+//Resolves the moves of all our squares at once. Each square lists its candidate moves, best first, without looking
+//at anybody else's. The resolver then runs deferred acceptance: every square proposes its current candidate to the
+//square it leads to, and every square keeps the proposals that fit below their caps, taken by priority and stopping
+//at the first that does not fit; a square staying put always fits and comes first. Rejected squares propose their
+//next candidate until they end on STILL. Keeping a priority prefix means a proposal that fits among some proposals
+//also fits among fewer of them, so the outcome does not depend on the order proposals are examined in, and as
+//candidates are only ever given up every square proposes at most MAX_MOVE_CANDIDATES + 1 times.
+//  load: after resolve_moves, our strength ending up in each square that moves lead into, stayers included
+struct MoveResolver
+{
+    std::vector<MoveCandidate> candidates;//[MAX_MOVE_CANDIDATES * index + rank]
+    std::vector<unsigned char> num_candidates;
+    std::vector<unsigned char> current;//rank being proposed, num_candidates for STILL
+    std::vector<int> priority;//lower goes first
+    std::vector<int> squares;//squares with candidates this frame
+    std::vector<int> pending;//squares whose proposals have to be examined again
+    std::vector<unsigned char> is_pending;
+    std::vector<int> load;
+};
+
+inline void init_move_resolver(MoveResolver &resolver, int cells)
+{
+    resolver.candidates.assign(MAX_MOVE_CANDIDATES * cells, MoveCandidate());
+    resolver.num_candidates.assign(cells, 0);
+    resolver.current.assign(cells, 0);
+    resolver.priority.assign(cells, 0);
+    resolver.squares.clear();
+    resolver.squares.reserve(cells);
+    resolver.pending.clear();
+    resolver.pending.reserve(cells);
+    resolver.is_pending.assign(cells, 0);
+    resolver.load.assign(cells, 0);
+}
+
+inline void clear_move_candidates(MoveResolver &resolver)
+{
+    resolver.squares.clear();
+}
+
+//Starts the candidate list of index. Squares must be added from the highest priority to the lowest.
+inline void add_move_square(MoveResolver &resolver, int index)
+{
+    resolver.priority[index] = resolver.squares.size();
+    resolver.num_candidates[index] = 0;
+    resolver.squares.push_back(index);
+}
+
+inline void add_move_candidate(MoveResolver &resolver, int index, unsigned char direction, TraceEvent event, int cap, int goal)
+{
+    MoveCandidate &candidate = resolver.candidates[MAX_MOVE_CANDIDATES * index + resolver.num_candidates[index]++];
+    candidate.direction = direction;
+    candidate.event = event;
+    candidate.cap = cap;
+    candidate.goal = goal;
+}
+
+//The candidate index ended on, NULL if it stays
+inline const MoveCandidate *get_resolved_candidate(const MoveResolver &resolver, int index)
+{
+    int rank = resolver.current[index];
+    return (rank < resolver.num_candidates[index]) ? &resolver.candidates[MAX_MOVE_CANDIDATES * index + rank] : NULL;
+}
+
+namespace move_resolver_detail
+{
+    inline unsigned char get_direction(const MoveResolver &resolver, int index)
+    {
+        const MoveCandidate *candidate = get_resolved_candidate(resolver, index);
+        return (candidate != NULL) ? candidate->direction : STILL;
+    }
+
+    inline void push(MoveResolver &resolver, int index)
+    {
+        if(!resolver.is_pending[index])
+        {
+            resolver.is_pending[index] = 1;
+            resolver.pending.push_back(index);
+        }
+    }
+
+    //Keeps the priority prefix of the proposals into index that fits and sends the rest on to their next candidate
+    inline void examine(MoveResolver &resolver, const MapSnapshot &present_map, unsigned char my_id, int index)
+    {
+        int load = 0;
+        if((present_map.owner[index] == my_id) && (get_direction(resolver, index) == STILL))
+        {
+            load = present_map.strength[index];
+        }
+        int movers[4];
+        int num_movers = 0;
+        for(int i = 0; i < 4; i++)
+        {
+            int neighbor = present_map.neighbor(index, CARDINALS[i]);
+            if((present_map.owner[neighbor] == my_id) && (get_direction(resolver, neighbor) == OPPOSITE[CARDINALS[i]]))
+            {
+                int j = num_movers++;
+                while((j > 0) && (resolver.priority[movers[j - 1]] > resolver.priority[neighbor]))
+                {
+                    movers[j] = movers[j - 1];
+                    j--;
+                }
+                movers[j] = neighbor;
+            }
+        }
+        bool full = false;
+        for(int j = 0; j < num_movers; j++)
+        {
+            int mover = movers[j];
+            int strength = present_map.strength[mover];
+            if(!full && (load + strength < get_resolved_candidate(resolver, mover)->cap))
+            {
+                load += strength;
+                continue;
+            }
+            full = true;
+            resolver.current[mover]++;
+            push(resolver, present_map.neighbor(mover, get_direction(resolver, mover)));
+        }
+        resolver.load[index] = load;
+    }
+}
+
+//Fills directions for every square with candidates
+inline void resolve_moves(MoveResolver &resolver, const MapSnapshot &present_map, unsigned char my_id,
+                          std::vector<unsigned char> &directions)
+{
+    for(size_t i = 0; i < resolver.squares.size(); i++)
+    {
+        int index = resolver.squares[i];
+        resolver.current[index] = 0;
+    }
+    for(size_t i = 0; i < resolver.squares.size(); i++)
+    {
+        int index = resolver.squares[i];
+        move_resolver_detail::push(resolver, present_map.neighbor(index, move_resolver_detail::get_direction(resolver, index)));
+    }
+    while(!resolver.pending.empty())
+    {
+        int index = resolver.pending.back();
+        resolver.pending.pop_back();
+        resolver.is_pending[index] = 0;
+        move_resolver_detail::examine(resolver, present_map, my_id, index);
+    }
+    for(size_t i = 0; i < resolver.squares.size(); i++)
+    {
+        int index = resolver.squares[i];
+        directions[index] = move_resolver_detail::get_direction(resolver, index);
+    }
+}
+
+#endif
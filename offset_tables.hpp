@@ -0,0 +1,96 @@
+#ifndef OFFSET_TABLES_H
+#define OFFSET_TABLES_H
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+//Everything that depends only on the wrapped offset between two squares, built once for the map size at init so
+//that the per-frame code does lookups instead of wrap-around tests, divisions and trigonometry.
+//  column, row: x and y of each square index
+//  offset_x, offset_y: wrapped signed offset in (-size / 2, size / 2] for a raw difference d, stored at d + size - 1
+//  distance_x, distance_y: its absolute value, so that distance() matches hlt::GameMap::getDistance
+//  falloff: 1 / d^3 for each Manhattan distance d, 0 for d = 0
+//  unit_x, unit_y: unit vector along each wrapped offset, as hlt::GameMap::getAngle gives it, indexed like a square
+//                  by (offset_y mod height) * width + (offset_x mod width); 0 along an axis that is exactly half a
+//                  lap long, since such a site pulls both ways at once
+struct OffsetTables
+{
+    int width;
+    int height;
+    std::vector<unsigned short> column;
+    std::vector<unsigned short> row;
+    std::vector<int> offset_x;
+    std::vector<int> offset_y;
+    std::vector<unsigned char> distance_x;
+    std::vector<unsigned char> distance_y;
+    std::vector<double> falloff;
+    std::vector<double> unit_x;
+    std::vector<double> unit_y;
+
+    int distance(int first, int second) const
+    {
+        return distance_x[column[second] - column[first] + width - 1] + distance_y[row[second] - row[first] + height - 1];
+    }
+};
+
+inline void init_offset_tables(OffsetTables &tables, int width, int height)
+{
+    tables.width = width;
+    tables.height = height;
+    tables.column.resize(width * height);
+    tables.row.resize(width * height);
+    for(int index = 0; index < width * height; index++)
+    {
+        tables.column[index] = index % width;
+        tables.row[index] = index / width;
+    }
+    tables.offset_x.resize(2 * width - 1);
+    tables.distance_x.resize(2 * width - 1);
+    for(int d = 1 - width; d < width; d++)
+    {
+        int wrapped = (d < 0) ? d + width : d;
+        if(2 * wrapped > width)
+        {
+            wrapped -= width;
+        }
+        tables.offset_x[d + width - 1] = wrapped;
+        tables.distance_x[d + width - 1] = std::abs(wrapped);
+    }
+    tables.offset_y.resize(2 * height - 1);
+    tables.distance_y.resize(2 * height - 1);
+    for(int d = 1 - height; d < height; d++)
+    {
+        int wrapped = (d < 0) ? d + height : d;
+        if(2 * wrapped > height)
+        {
+            wrapped -= height;
+        }
+        tables.offset_y[d + height - 1] = wrapped;
+        tables.distance_y[d + height - 1] = std::abs(wrapped);
+    }
+    tables.falloff.assign(width / 2 + height / 2 + 1, 0.0);
+    for(int d = 1; d < (int) tables.falloff.size(); d++)
+    {
+        tables.falloff[d] = 1.0 / ((double) d * d * d);
+    }
+    tables.unit_x.assign(width * height, 0.0);
+    tables.unit_y.assign(width * height, 0.0);
+    for(int y = 0; y < height; y++)
+    {
+        for(int x = 0; x < width; x++)
+        {
+            int ox = tables.offset_x[x + width - 1];
+            int oy = tables.offset_y[y + height - 1];
+            if((ox == 0) && (oy == 0))
+            {
+                continue;
+            }
+            double angle = atan2((double) oy, (double) ox);
+            tables.unit_x[y * width + x] = (2 * ox == width) ? 0.0 : cos(angle);
+            tables.unit_y[y * width + x] = (2 * oy == height) ? 0.0 : sin(angle);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef PADDED_GRID_H
+#define PADDED_GRID_H
+
+#include <algorithm>
+#include <vector>
+
+#include "hlt.hpp"
+
+//Layout of a plane stored with a one-square ghost border: square (x, y) sits at (y + 1) * stride + x + 1 and the
+//ghost cells hold copies of the squares the torus wraps to, so the four neighbors of any square are at the fixed
+//offsets offset[direction] with no wrap-around test. Corners are filled too but no neighbor lookup reaches them.
+struct PaddedGrid
+{
+    int width;
+    int height;
+    int stride;
+    int cells;//ghost border included
+    int offset[5];
+
+    int padded(int x, int y) const
+    {
+        return (y + 1) * stride + x + 1;
+    }
+};
+
+inline void init_padded_grid(PaddedGrid &grid, int width, int height)
+{
+    grid.width = width;
+    grid.height = height;
+    grid.stride = width + 2;
+    grid.cells = grid.stride * (height + 2);
+    grid.offset[STILL] = 0;
+    grid.offset[NORTH] = -grid.stride;
+    grid.offset[EAST] = 1;
+    grid.offset[SOUTH] = grid.stride;
+    grid.offset[WEST] = -1;
+}
+
+//Copies a row-major plane of width * height squares into padded, which holds grid.cells, and fills the ghost border
+template<typename T> void pad_plane(const PaddedGrid &grid, const T *plane, T *padded)
+{
+    for(int y = 0; y < grid.height; y++)
+    {
+        T *row = padded + grid.padded(0, y);
+        std::copy(plane + y * grid.width, plane + (y + 1) * grid.width, row);
+        row[-1] = row[grid.width - 1];
+        row[grid.width] = row[0];
+    }
+    const T *last_row = padded + grid.padded(-1, grid.height - 1);
+    const T *first_row = padded + grid.padded(-1, 0);
+    std::copy(last_row, last_row + grid.stride, padded);
+    std::copy(first_row, first_row + grid.stride, padded + grid.padded(-1, grid.height));
+}
+
+#endif
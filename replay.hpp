@@ -0,0 +1,154 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "frame_io.hpp"
+
+const char REPLAY_MAGIC[4] = {'H', 'R', 'P', 'L'};
+const unsigned REPLAY_VERSION = 1;
+const int INIT_LINES = 4;//player tag, map size, productions, first map
+
+//Binary record of one game as the bot saw it, in native byte order:
+//  magic, version, seed, init length, init text (the four init lines, '\n' terminated)
+//  then per frame: frame length, frame line, moves length, moves line, float milliseconds the frame took
+//Frames and moves are stored verbatim, so a replay goes through the same parser and planner as the game did.
+//The file is flushed after every frame, so it survives the environment killing the bot.
+struct ReplayRecorder
+{
+    std::ofstream file;
+};
+
+struct Replay
+{
+    unsigned seed;
+    std::string init;
+    std::vector<std::string> frames;
+    std::vector<std::string> moves;
+    std::vector<float> elapsed_ms;
+};
+
+namespace replay_detail
+{
+    inline void write_u32(std::ofstream &file, unsigned value)
+    {
+        file.write((const char *) &value, sizeof(value));
+    }
+
+    inline void write_bytes(std::ofstream &file, const char *data, unsigned length)
+    {
+        write_u32(file, length);
+        file.write(data, length);
+    }
+
+    inline bool read_u32(std::ifstream &file, unsigned &value)
+    {
+        return file.read((char *) &value, sizeof(value)).good();
+    }
+
+    //A length longer than what is left of the file means the recording is cut short or not a recording at all, so
+    //it ends the read instead of allocating that much
+    inline bool read_bytes(std::ifstream &file, std::string &data)
+    {
+        unsigned length;
+        if(!read_u32(file, length))
+        {
+            return false;
+        }
+        std::streampos position = file.tellg();
+        file.seekg(0, std::ios::end);
+        std::streamoff remaining = file.tellg() - position;
+        file.seekg(position);
+        if((position < 0) || (remaining < (std::streamoff) length))
+        {
+            return false;
+        }
+        data.resize(length);
+        return (length == 0) || file.read(&data[0], length).good();
+    }
+}
+
+//Reads the init lines from stdin and records them. They are handed back in init_input, which has to stand in for
+//std::cin while read_init runs.
+inline bool start_replay_recording(ReplayRecorder &recorder, const char *path, unsigned seed, std::stringbuf &init_input)
+{
+    recorder.file.open(path, std::ios::binary);
+    if(!recorder.file.is_open())
+    {
+        return false;
+    }
+    std::string init;
+    std::string line;
+    for(int i = 0; (i < INIT_LINES) && std::getline(std::cin, line); i++)
+    {
+        init += line;
+        init += '\n';
+    }
+    recorder.file.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    replay_detail::write_u32(recorder.file, REPLAY_VERSION);
+    replay_detail::write_u32(recorder.file, seed);
+    replay_detail::write_bytes(recorder.file, init.data(), init.size());
+    recorder.file.flush();
+    init_input.str(init);
+    return true;
+}
+
+//Call after write_moves, with io.line still holding the frame that was just answered
+inline void record_replay_frame(ReplayRecorder &recorder, const FrameIO &io, float elapsed_ms)
+{
+    if(!recorder.file.is_open())
+    {
+        return;
+    }
+    replay_detail::write_bytes(recorder.file, io.line.data(), io.line.size());
+    replay_detail::write_bytes(recorder.file, &io.out[0], io.out_length);
+    recorder.file.write((const char *) &elapsed_ms, sizeof(elapsed_ms));
+    recorder.file.flush();
+}
+
+//Loads a recording and fills input with the text the environment sent, ready to replace std::cin's buffer.
+//A recording cut short by a crash loads up to its last complete frame.
+inline bool load_replay(Replay &replay, const char *path, std::stringbuf &input)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(REPLAY_MAGIC)];
+    unsigned version;
+    if(!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), REPLAY_MAGIC) ||
+       !replay_detail::read_u32(file, version) || (version != REPLAY_VERSION) ||
+       !replay_detail::read_u32(file, replay.seed) || !replay_detail::read_bytes(file, replay.init))
+    {
+        return false;
+    }
+    std::string text = replay.init;
+    std::string frame;
+    std::string moves;
+    float elapsed_ms;
+    while(replay_detail::read_bytes(file, frame) && replay_detail::read_bytes(file, moves) &&
+          file.read((char *) &elapsed_ms, sizeof(elapsed_ms)))
+    {
+        replay.frames.push_back(frame);
+        replay.moves.push_back(moves);
+        replay.elapsed_ms.push_back(elapsed_ms);
+        text += frame;
+        text += '\n';
+    }
+    input.str(text);
+    return true;
+}
+
+//One line per replayed frame on stderr, so a slow or diverging frame can be found with grep or sort
+inline void report_replay_frame(const Replay &replay, int frame, const FrameIO &io, double elapsed_ms)
+{
+    bool same = (frame < (int) replay.moves.size()) &&
+                (replay.moves[frame].compare(0, std::string::npos, &io.out[0], io.out_length) == 0);
+    fprintf(stderr, "frame %d: %.3f ms, recorded %.3f ms, moves %s\n", frame, elapsed_ms,
+            (frame < (int) replay.elapsed_ms.size()) ? replay.elapsed_ms[frame] : 0.0f, same ? "same" : "differ");
+}
+
+#endif
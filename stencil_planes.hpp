@@ -0,0 +1,206 @@
+#ifndef STENCIL_PLANES_H
+#define STENCIL_PLANES_H
+
+#include <vector>
+
+#include "padded_grid.hpp"
+
+#if defined(__SSE2__) && !defined(BOT_NO_SIMD)
+    #define STENCIL_SSE2
+    #include <emmintrin.h>
+#endif
+
+//Whole-map planes derived from one frame for one player, computed in a single pass so that the per-square
+//heuristics become lookups. The planes the stencil reads are padded (see PaddedGrid), so all four neighbors are fixed
+//offsets away.
+//  ratio: production / strength, or production when the strength is 0
+//  enemy_pressure: summed strength of the enemy squares (neither ours nor neutral) next to the square
+//  value: what heuristic() returns for the square
+//  border: 1 if some neighbor is not ours, what is_on_border() returns
+//SSE2 processes 16 squares at a time, BOT_NO_SIMD forces the scalar version, which gives bit-identical planes.
+struct StencilPlanes
+{
+    std::vector<float> ratio;
+    std::vector<unsigned short> enemy_pressure;
+    std::vector<float> value;
+    std::vector<unsigned char> border;
+    std::vector<unsigned char> enemy_strength;//strength of enemy squares, 0 elsewhere
+    std::vector<unsigned char> mine;//0xff on our squares, 0 elsewhere
+    PaddedGrid grid;
+    std::vector<unsigned char> padded_enemy_strength;
+    std::vector<unsigned char> padded_mine;
+};
+
+inline void init_stencil_planes(StencilPlanes &planes, int width, int height)
+{
+    int cells = width * height;
+    planes.ratio.assign(cells, 0.0);
+    planes.enemy_pressure.assign(cells, 0);
+    planes.value.assign(cells, 0.0);
+    planes.border.assign(cells, 0);
+    planes.enemy_strength.assign(cells, 0);
+    planes.mine.assign(cells, 0);
+    init_padded_grid(planes.grid, width, height);
+    planes.padded_enemy_strength.assign(planes.grid.cells, 0);
+    planes.padded_mine.assign(planes.grid.cells, 0);
+}
+
+namespace stencil_planes_detail
+{
+    inline void square_planes(StencilPlanes &planes, int index, unsigned char owner, unsigned char strength,
+                              unsigned char production, unsigned char my_id)
+    {
+        planes.mine[index] = (owner == my_id) ? 0xff : 0;
+        planes.enemy_strength[index] = ((owner != my_id) && (owner != 0)) ? strength : 0;
+        planes.ratio[index] = strength ? static_cast<float>(production) / strength : static_cast<float>(production);
+    }
+
+    //padded is the position of index in the padded planes
+    inline void stencil(StencilPlanes &planes, int index, int padded, const unsigned char *owner, const unsigned char *strength)
+    {
+        const unsigned char *enemy = &planes.padded_enemy_strength[padded];
+        const unsigned char *mine = &planes.padded_mine[padded];
+        const int *offset = planes.grid.offset;
+        unsigned short pressure = enemy[offset[NORTH]] + enemy[offset[SOUTH]] + enemy[offset[WEST]] + enemy[offset[EAST]];
+        planes.enemy_pressure[index] = pressure;
+        planes.border[index] = (mine[offset[NORTH]] & mine[offset[SOUTH]] & mine[offset[WEST]] & mine[offset[EAST]]) ? 0 : 1;
+        if(owner[index] != 0)
+        {
+            planes.value[index] = pressure;
+        }
+        else
+        {
+            planes.value[index] = strength[index] ? planes.ratio[index] : planes.ratio[index] + pressure;
+        }
+    }
+
+#ifdef STENCIL_SSE2
+    //16 bytes of 0x00/0xff to four masks of 4 floats
+    inline void widen_mask(__m128i bytes, __m128 out[4])
+    {
+        __m128i low = _mm_unpacklo_epi8(bytes, bytes);
+        __m128i high = _mm_unpackhi_epi8(bytes, bytes);
+        out[0] = _mm_castsi128_ps(_mm_unpacklo_epi16(low, low));
+        out[1] = _mm_castsi128_ps(_mm_unpackhi_epi16(low, low));
+        out[2] = _mm_castsi128_ps(_mm_unpacklo_epi16(high, high));
+        out[3] = _mm_castsi128_ps(_mm_unpackhi_epi16(high, high));
+    }
+
+    //8 unsigned shorts to two groups of 4 floats
+    inline void widen_shorts(__m128i shorts, __m128 out[2])
+    {
+        __m128i zero = _mm_setzero_si128();
+        out[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(shorts, zero));
+        out[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(shorts, zero));
+    }
+
+    //16 unsigned bytes to four groups of 4 floats
+    inline void widen_bytes(__m128i bytes, __m128 out[4])
+    {
+        __m128i zero = _mm_setzero_si128();
+        widen_shorts(_mm_unpacklo_epi8(bytes, zero), out);
+        widen_shorts(_mm_unpackhi_epi8(bytes, zero), out + 2);
+    }
+
+    inline void square_planes_16(StencilPlanes &planes, int index, const unsigned char *owner,
+                                 const unsigned char *strength, const unsigned char *production, unsigned char my_id)
+    {
+        __m128i zero = _mm_setzero_si128();
+        __m128i owners = _mm_loadu_si128((const __m128i *) (owner + index));
+        __m128i strengths = _mm_loadu_si128((const __m128i *) (strength + index));
+        __m128i is_mine = _mm_cmpeq_epi8(owners, _mm_set1_epi8((char) my_id));
+        __m128i not_enemy = _mm_or_si128(is_mine, _mm_cmpeq_epi8(owners, zero));
+        _mm_storeu_si128((__m128i *) &planes.mine[index], is_mine);
+        _mm_storeu_si128((__m128i *) &planes.enemy_strength[index], _mm_andnot_si128(not_enemy, strengths));
+
+        __m128 strength_f[4];
+        __m128 production_f[4];
+        widen_bytes(strengths, strength_f);
+        widen_bytes(_mm_loadu_si128((const __m128i *) (production + index)), production_f);
+        for(int k = 0; k < 4; k++)
+        {
+            __m128 no_strength = _mm_cmpeq_ps(strength_f[k], _mm_setzero_ps());
+            __m128 ratio = _mm_div_ps(production_f[k], strength_f[k]);//masked out where strength is 0
+            ratio = _mm_or_ps(_mm_and_ps(no_strength, production_f[k]), _mm_andnot_ps(no_strength, ratio));
+            _mm_storeu_ps(&planes.ratio[index + 4 * k], ratio);
+        }
+    }
+
+    inline void stencil_16(StencilPlanes &planes, int index, int padded, const unsigned char *owner, const unsigned char *strength)
+    {
+        __m128i zero = _mm_setzero_si128();
+        const unsigned char *enemy = &planes.padded_enemy_strength[padded];
+        const unsigned char *mine = &planes.padded_mine[padded];
+        const int *offset = planes.grid.offset;
+        __m128i enemy_north = _mm_loadu_si128((const __m128i *) (enemy + offset[NORTH]));
+        __m128i enemy_south = _mm_loadu_si128((const __m128i *) (enemy + offset[SOUTH]));
+        __m128i enemy_west = _mm_loadu_si128((const __m128i *) (enemy + offset[WEST]));
+        __m128i enemy_east = _mm_loadu_si128((const __m128i *) (enemy + offset[EAST]));
+        __m128i pressure_low = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(enemy_north, zero), _mm_unpacklo_epi8(enemy_south, zero)),
+                                             _mm_add_epi16(_mm_unpacklo_epi8(enemy_west, zero), _mm_unpacklo_epi8(enemy_east, zero)));
+        __m128i pressure_high = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(enemy_north, zero), _mm_unpackhi_epi8(enemy_south, zero)),
+                                              _mm_add_epi16(_mm_unpackhi_epi8(enemy_west, zero), _mm_unpackhi_epi8(enemy_east, zero)));
+        _mm_storeu_si128((__m128i *) &planes.enemy_pressure[index], pressure_low);
+        _mm_storeu_si128((__m128i *) &planes.enemy_pressure[index + 8], pressure_high);
+
+        __m128i surrounded = _mm_and_si128(
+            _mm_and_si128(_mm_loadu_si128((const __m128i *) (mine + offset[NORTH])), _mm_loadu_si128((const __m128i *) (mine + offset[SOUTH]))),
+            _mm_and_si128(_mm_loadu_si128((const __m128i *) (mine + offset[WEST])), _mm_loadu_si128((const __m128i *) (mine + offset[EAST]))));
+        _mm_storeu_si128((__m128i *) &planes.border[index], _mm_andnot_si128(surrounded, _mm_set1_epi8(1)));
+
+        __m128 pressure[4];
+        widen_shorts(pressure_low, pressure);
+        widen_shorts(pressure_high, pressure + 2);
+        __m128 neutral[4];
+        __m128 no_strength[4];
+        widen_mask(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (owner + index)), zero), neutral);
+        widen_mask(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) (strength + index)), zero), no_strength);
+        for(int k = 0; k < 4; k++)
+        {
+            __m128 neutral_value = _mm_add_ps(_mm_loadu_ps(&planes.ratio[index + 4 * k]), _mm_and_ps(no_strength[k], pressure[k]));
+            __m128 value = _mm_or_ps(_mm_and_ps(neutral[k], neutral_value), _mm_andnot_ps(neutral[k], pressure[k]));
+            _mm_storeu_ps(&planes.value[index + 4 * k], value);
+        }
+    }
+#endif
+}
+
+//Must run once per frame after the owner and strength planes have been updated
+inline void update_stencil_planes(StencilPlanes &planes, const unsigned char *owner, const unsigned char *strength,
+                                  const unsigned char *production, int width, int height, unsigned char my_id)
+{
+    int cells = width * height;
+    int index = 0;
+    #ifdef STENCIL_SSE2
+        for(; index + 16 <= cells; index += 16)
+        {
+            stencil_planes_detail::square_planes_16(planes, index, owner, strength, production, my_id);
+        }
+    #endif
+    for(; index < cells; index++)
+    {
+        stencil_planes_detail::square_planes(planes, index, owner[index], strength[index], production[index], my_id);
+    }
+
+    const PaddedGrid &grid = planes.grid;
+    pad_plane(grid, &planes.enemy_strength[0], &planes.padded_enemy_strength[0]);
+    pad_plane(grid, &planes.mine[0], &planes.padded_mine[0]);
+    for(int y = 0; y < height; y++)
+    {
+        int row = y * width;
+        int padded_row = grid.padded(0, y);
+        int x = 0;
+        #ifdef STENCIL_SSE2
+            for(; x + 16 <= width; x += 16)
+            {
+                stencil_planes_detail::stencil_16(planes, row + x, padded_row + x, owner, strength);
+            }
+        #endif
+        for(; x < width; x++)
+        {
+            stencil_planes_detail::stencil(planes, row + x, padded_row + x, owner, strength);
+        }
+    }
+}
+
+#endif
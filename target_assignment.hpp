@@ -0,0 +1,188 @@
+#ifndef TARGET_ASSIGNMENT_H
+#define TARGET_ASSIGNMENT_H
+
+#include <cstdlib>
+#include <vector>
+
+#include "map_snapshot.hpp"
+#include "territory.hpp"
+
+const int ASSIGNMENT_TARGETS = 8;
+
+//Which of our squares work towards which of the ASSIGNMENT_TARGETS best border targets. Each target needs one more
+//than its strength; squares are matched to it nearest first until the strength heading there covers that, so a
+//target does not draw more squares than it can use and the rest go to the next one. A square keeps its target from
+//one frame to the next for as long as the target stays among the best and the square can still step towards it
+//through our territory, so only targets that are new or short of strength are searched for again.
+struct TargetAssignment
+{
+    int num_targets;
+    int targets[ASSIGNMENT_TARGETS];
+    int required[ASSIGNMENT_TARGETS];
+    int collected[ASSIGNMENT_TARGETS];
+    std::vector<int> slot;//index into targets for the squares assigned this frame, -1 elsewhere
+    std::vector<unsigned char> direction;//next step of an assigned square
+    std::vector<int> assigned;
+    std::vector<int> carried;//target square the piece now on each square was heading for last frame, -1 if none
+    std::vector<int> carried_squares;
+    std::vector<int> queue;
+    std::vector<int> wave;//target whose search reached the square first
+    std::vector<int> visited;
+    int stamp;
+};
+
+inline void init_target_assignment(TargetAssignment &assignment, int cells)
+{
+    assignment.num_targets = 0;
+    assignment.slot.assign(cells, -1);
+    assignment.direction.assign(cells, STILL);
+    assignment.assigned.clear();
+    assignment.assigned.reserve(cells);
+    assignment.carried.assign(cells, -1);
+    assignment.carried_squares.clear();
+    assignment.carried_squares.reserve(cells);
+    assignment.queue.clear();
+    assignment.queue.reserve(cells);
+    assignment.wave.assign(cells, -1);
+    assignment.visited.assign(cells, 0);
+    assignment.stamp = 0;
+}
+
+namespace target_assignment_detail
+{
+    //A step from index that gets closer to target and stays in our territory (or enters the target), STILL if none.
+    //The longer axis goes first.
+    inline unsigned char step_towards(int index, int target, const MapSnapshot &present_map, unsigned char my_id)
+    {
+        const OffsetTables &offsets = *present_map.offsets;
+        int dx = offsets.offset_x[offsets.column[target] - offsets.column[index] + offsets.width - 1];
+        int dy = offsets.offset_y[offsets.row[target] - offsets.row[index] + offsets.height - 1];
+        unsigned char horizontal = (dx > 0) ? EAST : ((dx < 0) ? WEST : STILL);
+        unsigned char vertical = (dy > 0) ? SOUTH : ((dy < 0) ? NORTH : STILL);
+        unsigned char order[2] = {horizontal, vertical};
+        if(std::abs(dy) > std::abs(dx))
+        {
+            order[0] = vertical;
+            order[1] = horizontal;
+        }
+        for(int i = 0; i < 2; i++)
+        {
+            int next = present_map.neighbor(index, order[i]);
+            if((order[i] != STILL) && ((present_map.owner[next] == my_id) || (next == target)))
+            {
+                return order[i];
+            }
+        }
+        return STILL;
+    }
+
+    inline void assign(TargetAssignment &assignment, int index, int slot, unsigned char direction, const MapSnapshot &present_map)
+    {
+        assignment.slot[index] = slot;
+        assignment.direction[index] = direction;
+        assignment.collected[slot] += present_map.strength[index];
+        assignment.assigned.push_back(index);
+    }
+}
+
+//Must run after update_territory. Picks the targets, keeps the carried squares that can still reach theirs and
+//fills what is missing with one breadth-first search through our territory from every target that is still short,
+//each target's search stopping once it has collected enough.
+inline void update_target_assignment(TargetAssignment &assignment, const MapSnapshot &present_map, const Territory &territory,
+                                     unsigned char my_id)
+{
+    for(size_t i = 0; i < assignment.assigned.size(); i++)
+    {
+        assignment.slot[assignment.assigned[i]] = -1;
+    }
+    assignment.assigned.clear();
+    assignment.num_targets = get_best_targets(territory, ASSIGNMENT_TARGETS, assignment.targets);
+    for(int t = 0; t < assignment.num_targets; t++)
+    {
+        assignment.required[t] = present_map.strength[assignment.targets[t]] + 1;
+        assignment.collected[t] = 0;
+    }
+
+    for(size_t i = 0; i < assignment.carried_squares.size(); i++)
+    {
+        int index = assignment.carried_squares[i];
+        int target = assignment.carried[index];
+        assignment.carried[index] = -1;
+        if((present_map.owner[index] != my_id) || (assignment.slot[index] != -1) || is_weak(index, present_map))
+        {
+            continue;
+        }
+        for(int t = 0; t < assignment.num_targets; t++)
+        {
+            if((assignment.targets[t] == target) && (assignment.collected[t] < assignment.required[t]))
+            {
+                unsigned char direction = target_assignment_detail::step_towards(index, target, present_map, my_id);
+                if(direction != STILL)
+                {
+                    target_assignment_detail::assign(assignment, index, t, direction, present_map);
+                }
+                break;
+            }
+        }
+    }
+    assignment.carried_squares.clear();
+
+    assignment.stamp++;
+    assignment.queue.clear();
+    for(int t = 0; t < assignment.num_targets; t++)
+    {
+        if(assignment.collected[t] < assignment.required[t])
+        {
+            assignment.visited[assignment.targets[t]] = assignment.stamp;
+            assignment.wave[assignment.targets[t]] = t;
+            assignment.queue.push_back(assignment.targets[t]);
+        }
+    }
+    for(size_t head = 0; head < assignment.queue.size(); head++)
+    {
+        int current = assignment.queue[head];
+        int t = assignment.wave[current];
+        if(assignment.collected[t] >= assignment.required[t])
+        {
+            continue;//this target's search is over
+        }
+        for(int i = 0; i < 4; i++)
+        {
+            int neighbor = present_map.neighbor(current, CARDINALS[i]);
+            if((present_map.owner[neighbor] != my_id) || (assignment.visited[neighbor] == assignment.stamp))
+            {
+                continue;
+            }
+            assignment.visited[neighbor] = assignment.stamp;
+            assignment.wave[neighbor] = t;
+            assignment.queue.push_back(neighbor);
+            if((assignment.slot[neighbor] == -1) && !is_weak(neighbor, present_map))
+            {
+                target_assignment_detail::assign(assignment, neighbor, t, OPPOSITE[CARDINALS[i]], present_map);
+            }
+        }
+    }
+}
+
+//Once the moves are final, every assigned square hands its target on to the square it moves to
+inline void carry_target_assignment(TargetAssignment &assignment, const MapSnapshot &present_map,
+                                    const std::vector<unsigned char> &directions)
+{
+    for(size_t i = 0; i < assignment.assigned.size(); i++)
+    {
+        int index = assignment.assigned[i];
+        int target = assignment.targets[assignment.slot[index]];
+        int next = present_map.neighbor(index, directions[index]);
+        if(next == target)
+        {
+            continue;
+        }
+        if(assignment.carried[next] == -1)
+        {
+            assignment.carried_squares.push_back(next);
+        }
+        assignment.carried[next] = target;
+    }
+}
+
+#endif
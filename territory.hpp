@@ -0,0 +1,164 @@
+#ifndef TERRITORY_H
+#define TERRITORY_H
+
+#include <vector>
+
+//Frame-to-frame bookkeeping about our territory that is patched from MapSnapshot::changed instead of being rebuilt:
+//the size of the territory, the border (squares we do not own next to one we do) and the best border target.
+//Targets live in an indexed max-heap ordered by value, ties going to the square seen first by a row-major scan of
+//our territory, which is the order get_best_target_on_border_location used to pick in.
+struct Territory
+{
+    int my_area;
+    std::vector<unsigned char> mine;
+    std::vector<int> border;
+    std::vector<int> border_position;//position in border, -1 if not on the border
+    std::vector<float> value;
+    std::vector<int> scan_order;
+    std::vector<int> heap;
+    std::vector<int> heap_position;
+    std::vector<int> visited;//frame stamp of the last update that revisited the square
+    int stamp;
+
+    bool is_border(int index) const
+    {
+        return border_position[index] != -1;
+    }
+
+    bool better(int first, int second) const
+    {
+        return (value[first] > value[second]) || ((value[first] == value[second]) && (scan_order[first] < scan_order[second]));
+    }
+
+    //First border square in scan order among those with the highest value, or 0 if there is no border
+    int best_target() const
+    {
+        return heap.empty() ? 0 : heap[0];
+    }
+};
+
+namespace territory_detail
+{
+    inline void swap_heap(Territory &territory, int first, int second)
+    {
+        int tmp = territory.heap[first];
+        territory.heap[first] = territory.heap[second];
+        territory.heap[second] = tmp;
+        territory.heap_position[territory.heap[first]] = first;
+        territory.heap_position[territory.heap[second]] = second;
+    }
+
+    inline void sift(Territory &territory, int position)
+    {
+        while((position > 0) && territory.better(territory.heap[position], territory.heap[(position - 1) / 2]))
+        {
+            swap_heap(territory, position, (position - 1) / 2);
+            position = (position - 1) / 2;
+        }
+        int size = territory.heap.size();
+        while(true)
+        {
+            int best = position;
+            int left = 2 * position + 1;
+            int right = left + 1;
+            if((left < size) && territory.better(territory.heap[left], territory.heap[best]))
+            {
+                best = left;
+            }
+            if((right < size) && territory.better(territory.heap[right], territory.heap[best]))
+            {
+                best = right;
+            }
+            if(best == position)
+            {
+                break;
+            }
+            swap_heap(territory, position, best);
+            position = best;
+        }
+    }
+}
+
+inline void init_territory(Territory &territory, int cells)
+{
+    territory.my_area = 0;
+    territory.mine.assign(cells, 0);
+    territory.border.clear();
+    territory.border.reserve(cells);
+    territory.border_position.assign(cells, -1);
+    territory.value.assign(cells, 0.0);
+    territory.scan_order.assign(cells, 0);
+    territory.heap.clear();
+    territory.heap.reserve(cells);
+    territory.heap_position.assign(cells, -1);
+    territory.visited.assign(cells, 0);
+    territory.stamp = 0;
+}
+
+inline void add_border(Territory &territory, int index, float value, int scan_order)
+{
+    territory.value[index] = value;
+    territory.scan_order[index] = scan_order;
+    if(territory.border_position[index] == -1)
+    {
+        territory.border_position[index] = territory.border.size();
+        territory.border.push_back(index);
+        territory.heap_position[index] = territory.heap.size();
+        territory.heap.push_back(index);
+    }
+    territory_detail::sift(territory, territory.heap_position[index]);
+}
+
+inline void remove_border(Territory &territory, int index)
+{
+    int position = territory.border_position[index];
+    if(position == -1)
+    {
+        return;
+    }
+    int last = territory.border.back();
+    territory.border[position] = last;
+    territory.border_position[last] = position;
+    territory.border.pop_back();
+    territory.border_position[index] = -1;
+
+    position = territory.heap_position[index];
+    territory_detail::swap_heap(territory, position, territory.heap.size() - 1);
+    territory.heap.pop_back();
+    territory.heap_position[index] = -1;
+    if(position < (int) territory.heap.size())
+    {
+        territory_detail::sift(territory, position);
+    }
+}
+
+//The (up to) count best border targets (count at most 62), best first, read off the heap without popping it: the
+//next best is always a child of one already taken, so only O(count) heap entries are looked at
+inline int get_best_targets(const Territory &territory, int count, int *targets)
+{
+    int candidates[64];//heap positions, at most count + 1 of them live at once
+    int num_candidates = territory.heap.empty() ? 0 : 1;
+    int num_targets = 0;
+    candidates[0] = 0;
+    while((num_targets < count) && (num_candidates > 0))
+    {
+        int best = 0;
+        for(int i = 1; i < num_candidates; i++)
+        {
+            if(territory.better(territory.heap[candidates[i]], territory.heap[candidates[best]]))
+            {
+                best = i;
+            }
+        }
+        int position = candidates[best];
+        candidates[best] = candidates[--num_candidates];
+        targets[num_targets++] = territory.heap[position];
+        for(int child = 2 * position + 1; (child <= 2 * position + 2) && (child < (int) territory.heap.size()); child++)
+        {
+            candidates[num_candidates++] = child;
+        }
+    }
+    return num_targets;
+}
+
+#endif
@@ -0,0 +1,248 @@
+//Micro-benchmarks for the per-frame hot functions, run on maps taken from seeded local games at several map sizes
+//and territory sizes. Prints one CSV line per benchmark and map, so two builds can be compared with a diff:
+//
+//  bench [--seed S] [--min-ms T]
+//
+//benchmark,width,height,territory,ops,ns_per_op,allocs_per_op
+//
+//allocs_per_op counts every operator new in the process, worker threads included.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <set>
+#include <vector>
+
+#include "../bot.hpp"
+#include "local_game.hpp"
+
+const int BENCH_SIZES[] = {20, 30, 40, 50};
+const float BENCH_TERRITORIES[] = {0.05, 0.2, 0.5};
+const int FORCE_SOURCES_PER_SQUARE = 16;
+
+static std::atomic<long long> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+    void *memory = malloc(size ? size : 1);
+    if(memory == NULL)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+//Kept out of line, otherwise gcc sees free() on memory from a (builtin) operator new and warns
+__attribute__((noinline)) void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+//Two consecutive frames of the same game, so the full-frame benchmark pays for a realistic frame diff
+struct BenchMap
+{
+    hlt::GameMap frames[2];
+    float territory;
+};
+
+volatile float sink;
+
+//Plays the bot against the greedy baseline and keeps the frames where the bot first reaches each territory size
+void get_bench_maps(int size, unsigned seed, WorkerPool &pool, std::vector<BenchMap> &maps)
+{
+    LocalGame game;
+    generate_local_game(game, size, size, 2, seed);
+    static Bot bot;
+    init_bot(bot, 1, game.map, pool);
+    std::set<hlt::Move> moves;
+    size_t level = 0;
+    int cells = game.map.width * game.map.height;
+    while(!local_game_over(game) && (level < sizeof(BENCH_TERRITORIES) / sizeof(BENCH_TERRITORIES[0])))
+    {
+        hlt::GameMap previous = game.map;
+        bot.deadline.start();
+        plan_frame(bot, game.map);
+        set_local_directions(game, 1, bot.directions);
+        moves.clear();
+        get_greedy_moves(game.map, 2, moves);
+        set_local_moves(game, 2, moves);
+        play_local_turn(game);
+        if(game.territory[0] >= BENCH_TERRITORIES[level] * cells)
+        {
+            BenchMap map;
+            map.frames[0] = previous;
+            map.frames[1] = game.map;
+            map.territory = (float) game.territory[0] / cells;
+            maps.push_back(map);
+            level++;
+        }
+    }
+}
+
+//Repeats body until min_ms have passed; body returns how many operations it did
+template<typename Body> void run_bench(const char *name, const BenchMap &map, double min_ms, Body body)
+{
+    body();
+    long long ops = 0;
+    long long allocations_before = allocations.load();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double elapsed_ns = 0.0;
+    while(elapsed_ns < min_ms * 1e6)
+    {
+        ops += body();
+        elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    printf("%s,%d,%d,%.3f,%lld,%.1f,%.3f\n", name, map.frames[1].width, map.frames[1].height, map.territory, ops,
+           elapsed_ns / ops, (double) (allocations.load() - allocations_before) / ops);
+    fflush(stdout);
+}
+
+void bench_map(const BenchMap &map, WorkerPool &pool, double min_ms)
+{
+    static Bot bot;
+    init_bot(bot, 1, map.frames[1], pool);
+    bot.deadline.start();
+    plan_frame(bot, map.frames[1]);
+    const MapSnapshot &snapshot = bot.snapshot;
+    unsigned char my_id = bot.my_id;
+    std::vector<int> owned;
+    for(int index = 0; index < snapshot.cells; index++)
+    {
+        if(snapshot.owner[index] == my_id)
+        {
+            owned.push_back(index);
+        }
+    }
+    const std::vector<int> &border = bot.territory.border;
+    int sources = std::min((int) border.size(), FORCE_SOURCES_PER_SQUARE);
+
+    run_bench("update_snapshot_planes", map, min_ms, [&]() -> long long {
+        update_snapshot_planes(bot.snapshot, my_id);
+        return 1;
+    });
+    run_bench("compute_force", map, min_ms, [&]() -> long long {
+        float total = 0.0;
+        for(size_t i = 0; i < owned.size(); i++)
+        {
+            for(int j = 0; j < sources; j++)
+            {
+                total += compute_force(owned[i], border[j], snapshot, snapshot.distance(owned[i], border[j]), my_id);
+            }
+        }
+        sink = total;
+        return owned.size() * sources;
+    });
+    run_bench("heuristic", map, min_ms, [&]() -> long long {
+        float total = 0.0;
+        for(int index = 0; index < snapshot.cells; index++)
+        {
+            total += heuristic(index, snapshot, my_id);
+        }
+        sink = total;
+        return snapshot.cells;
+    });
+    run_bench("is_on_border", map, min_ms, [&]() -> long long {
+        int total = 0;
+        for(int index = 0; index < snapshot.cells; index++)
+        {
+            total += is_on_border(index, snapshot, my_id);
+        }
+        sink = total;
+        return snapshot.cells;
+    });
+    run_bench("update_flow_field", map, min_ms, [&]() -> long long {
+        update_flow_field(bot.flow, snapshot, bot.territory, my_id);
+        return 1;
+    });
+    //nothing is carried after the first pass, so this times a full search for every target
+    run_bench("update_target_assignment", map, min_ms, [&]() -> long long {
+        update_target_assignment(bot.assignment, snapshot, bot.territory, my_id);
+        return 1;
+    });
+    run_bench("get_best_target_on_border_location", map, min_ms, [&]() -> long long {
+        sink = get_best_target_on_border_location(snapshot, my_id);
+        return 1;
+    });
+    const std::vector<int> &refine_order = bot.refine_order;
+    run_bench("add_move_candidates", map, min_ms, [&]() -> long long {
+        clear_move_candidates(bot.resolver);
+        for(size_t i = 0; i < refine_order.size(); i++)
+        {
+            int index = refine_order[i];
+            add_move_candidates(index, bot.plans[index], snapshot, my_id, bot.flow, bot.assignment, bot.resolver);
+        }
+        return refine_order.size();
+    });
+    //on the candidates listed above, the bot's own from the first frame
+    run_bench("resolve_moves", map, min_ms, [&]() -> long long {
+        resolve_moves(bot.resolver, snapshot, my_id, bot.directions);
+        sink = bot.directions[refine_order[0]];
+        return refine_order.size();
+    });
+    //one zone of the first border squares, with every target as an option; one op is one simulated candidate
+    std::vector<int> group;
+    unsigned char targets[ZONE_MAX_SQUARES][4];
+    unsigned char num_targets[ZONE_MAX_SQUARES];
+    unsigned char directions[ZONE_MAX_SQUARES];
+    int candidates = 1;
+    for(size_t i = 0; (i < owned.size()) && (group.size() < (size_t) ZONE_MAX_SQUARES); i++)
+    {
+        const SquarePlan &plan = bot.plans[owned[i]];
+        if(plan.on_border && (candidates * (plan.num_targets + 1) <= ZONE_MAX_CANDIDATES))
+        {
+            std::copy(plan.targets, plan.targets + plan.num_targets, targets[group.size()]);
+            num_targets[group.size()] = plan.num_targets;
+            candidates *= plan.num_targets + 1;
+            group.push_back(owned[i]);
+        }
+    }
+    if(!group.empty())
+    {
+        run_bench("solve_zone", map, min_ms, [&]() -> long long {
+            solve_zone(bot.frontier, snapshot, my_id, group, targets, num_targets, directions);
+            sink = directions[0];
+            return candidates;
+        });
+    }
+
+    int frame = 0;
+    run_bench("frame", map, min_ms, [&]() -> long long {
+        bot.deadline.start();
+        plan_frame(bot, map.frames[frame]);
+        frame ^= 1;
+        return 1;
+    });
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seed = 1;
+    double min_ms = 200.0;
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        if(!strcmp(argv[i], "--seed")) seed = strtoul(argv[i + 1], NULL, 10);
+        else if(!strcmp(argv[i], "--min-ms")) min_ms = atof(argv[i + 1]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--seed S] [--min-ms T]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    WorkerPool pool(get_planner_threads());
+    printf("benchmark,width,height,territory,ops,ns_per_op,allocs_per_op\n");
+    for(size_t s = 0; s < sizeof(BENCH_SIZES) / sizeof(BENCH_SIZES[0]); s++)
+    {
+        std::vector<BenchMap> maps;
+        get_bench_maps(BENCH_SIZES[s], seed, pool, maps);
+        for(size_t i = 0; i < maps.size(); i++)
+        {
+            bench_map(maps[i], pool, min_ms);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+//Checks the whole-map planes against the wrap-around semantics of the game: update_snapshot_planes on random maps
+//of odd and mixed sizes, compared square by square with a reference that walks neighbors through
+//hlt::GameMap::getLocation and uses the heuristic and is_on_border formulas from before the planes. Build it once
+//as is and once with -DBOT_NO_SIMD to cover both stencils. Prints the first mismatches and exits with 1 if there
+//are any.
+//
+//  grid_check [--seed S] [--maps N]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../map_tables.hpp"
+#include "../map_snapshot.hpp"
+
+const int CHECK_SIZES[][2] = {{21, 21}, {35, 21}, {21, 47}, {33, 33}, {20, 20}, {50, 29}, {17, 50}};
+const int CHECK_PLAYERS = 4;
+const int MAX_REPORTED = 10;
+
+//The planes as the baseline computed them, one square at a time on the GameMap
+struct ReferenceSquare
+{
+    float value;
+    unsigned short enemy_pressure;
+    unsigned char border;
+};
+
+ReferenceSquare get_reference(hlt::GameMap &present_map, hlt::Location location, unsigned char my_id)
+{
+    ReferenceSquare reference;
+    const hlt::Site &site = present_map.getSite(location);
+    reference.enemy_pressure = 0;
+    reference.border = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        const hlt::Site &neighbor = present_map.getSite(present_map.getLocation(location, CARDINALS[i]));
+        if((neighbor.owner != my_id) && (neighbor.owner != 0))
+        {
+            reference.enemy_pressure += neighbor.strength;
+        }
+        if(neighbor.owner != my_id)
+        {
+            reference.border = 1;
+        }
+    }
+    if((site.owner == 0) && (site.strength > 0))
+    {
+        reference.value = static_cast<float>(site.production) / site.strength;
+    }
+    else
+    {
+        float strength = (site.owner == 0) ? site.production : 0.0;
+        for(int i = 0; i < 4; i++)
+        {
+            const hlt::Site &neighbor = present_map.getSite(present_map.getLocation(location, CARDINALS[i]));
+            if((neighbor.owner != my_id) && (neighbor.owner != 0))
+            {
+                strength += neighbor.strength;
+            }
+        }
+        reference.value = strength;
+    }
+    return reference;
+}
+
+//Owners come in clumps of a random size, so maps have interior squares as well as borders, with some strength 0
+//squares for the ratio's special case
+void fill_random_map(hlt::GameMap &present_map, std::mt19937 &random)
+{
+    std::uniform_int_distribution<int> owner(0, CHECK_PLAYERS);
+    std::uniform_int_distribution<int> strength(0, 255);
+    std::uniform_int_distribution<int> production(0, 15);
+    std::uniform_int_distribution<int> percent(0, 99);
+    int keep = percent(random);//chance that a square keeps the owner of the one before it
+    int zero = percent(random) / 2;
+    unsigned char previous = 0;
+    for(int y = 0; y < present_map.height; y++)
+    {
+        for(int x = 0; x < present_map.width; x++)
+        {
+            hlt::Site &site = present_map.contents[y][x];
+            if(percent(random) >= keep)
+            {
+                previous = owner(random);
+            }
+            site.owner = previous;
+            site.strength = (percent(random) < zero) ? 0 : strength(random);
+            site.production = production(random);
+        }
+    }
+}
+
+//Returns the number of mismatching squares and reports the first few
+int check_map(hlt::GameMap &present_map, MapSnapshot &snapshot, unsigned char my_id, int &reported)
+{
+    update_snapshot_planes(snapshot, my_id);
+    const StencilPlanes &planes = snapshot.planes;
+    int mismatches = 0;
+    for(unsigned short y = 0; y < present_map.height; y++)
+    {
+        for(unsigned short x = 0; x < present_map.width; x++)
+        {
+            hlt::Location location = {x, y};
+            int index = y * present_map.width + x;
+            ReferenceSquare reference = get_reference(present_map, location, my_id);
+            if((planes.value[index] == reference.value) && (planes.enemy_pressure[index] == reference.enemy_pressure) &&
+               (planes.border[index] == reference.border))
+            {
+                continue;
+            }
+            mismatches++;
+            if(reported++ < MAX_REPORTED)
+            {
+                printf("%dx%d player %d square (%d, %d): value %g/%g enemy_pressure %d/%d border %d/%d (planes/reference)\n",
+                       present_map.width, present_map.height, my_id, x, y, planes.value[index], reference.value,
+                       planes.enemy_pressure[index], reference.enemy_pressure, planes.border[index], reference.border);
+            }
+        }
+    }
+    return mismatches;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned seed = 1;
+    int maps = 20;
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        if(!strcmp(argv[i], "--seed")) seed = strtoul(argv[i + 1], NULL, 10);
+        else if(!strcmp(argv[i], "--maps")) maps = atoi(argv[i + 1]);
+        else
+        {
+            fprintf(stderr, "usage: %s [--seed S] [--maps N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::mt19937 random(seed);
+    long long squares = 0;
+    int mismatches = 0;
+    int reported = 0;
+    for(size_t s = 0; s < sizeof(CHECK_SIZES) / sizeof(CHECK_SIZES[0]); s++)
+    {
+        int width = CHECK_SIZES[s][0];
+        int height = CHECK_SIZES[s][1];
+        std::shared_ptr<const MapTables> tables = make_map_tables(width, height);
+        MapSnapshot snapshot;
+        init_map_snapshot(snapshot, *tables);
+        hlt::GameMap present_map(width, height);
+        for(int m = 0; m < maps; m++)
+        {
+            fill_random_map(present_map, random);
+            update_map_snapshot(snapshot, present_map);//snapshot carried over from the last map, as between frames
+            for(unsigned char my_id = 1; my_id <= CHECK_PLAYERS; my_id++)
+            {
+                mismatches += check_map(present_map, snapshot, my_id, reported);
+                squares += width * height;
+            }
+        }
+    }
+#ifdef STENCIL_SSE2
+    const char *stencil = "sse2";
+#else
+    const char *stencil = "scalar";
+#endif
+    printf("%s stencil: %d of %lld squares mismatch\n", stencil, mismatches, squares);
+    return (mismatches == 0) ? 0 : 1;
+}
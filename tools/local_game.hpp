@@ -0,0 +1,395 @@
+#ifndef LOCAL_GAME_H
+#define LOCAL_GAME_H
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "../hlt.hpp"
+
+const int MAX_PLAYERS = 6;
+const int MAX_PRODUCTION = 15;
+const int SMOOTHING_PASSES = 4;
+
+//In-process copy of the 2016 environment: the same move, merge, production and combat rules as the server, minus
+//networking and timeouts. Players are numbered 1..num_players like on the server, index p - 1 in the vectors.
+struct LocalGame
+{
+    hlt::GameMap map;
+    int num_players;
+    int turn;
+    int max_turns;
+    std::vector<int> territory;
+    std::vector<int> total_strength;
+    std::vector<int> eliminated;//turn the player lost its last square, -1 while alive
+    std::vector< std::vector<unsigned char> > directions;//directions[p][y * width + x], reset to STILL every turn
+    std::vector< std::vector<int> > pieces;//strength of p's piece on the square after moving, -1 if none
+    std::vector< std::vector<int> > injury;//damage dealt to that piece, -1 if nothing attacks it
+    std::vector<int> neutral_damage;
+};
+
+namespace local_game_detail
+{
+    //Box blur that wraps around the tile, so that tiles repeated next to each other have no seams
+    inline void smooth(std::vector<float> &field, int width, int height)
+    {
+        std::vector<float> blurred(field.size());
+        for(int y = 0; y < height; y++)
+        {
+            for(int x = 0; x < width; x++)
+            {
+                float sum = 0.0;
+                for(int dy = -1; dy <= 1; dy++)
+                {
+                    for(int dx = -1; dx <= 1; dx++)
+                    {
+                        sum += field[((y + dy + height) % height) * width + (x + dx + width) % width];
+                    }
+                }
+                blurred[y * width + x] = sum / 9.0;
+            }
+        }
+        field.swap(blurred);
+    }
+
+    inline void normalize(std::vector<float> &field)
+    {
+        float low = *std::min_element(field.begin(), field.end());
+        float high = *std::max_element(field.begin(), field.end());
+        for(size_t i = 0; i < field.size(); i++)
+        {
+            field[i] = (high > low) ? (field[i] - low) / (high - low) : 0.5;
+        }
+    }
+
+    inline void random_field(std::vector<float> &field, int width, int height, std::mt19937 &rng)
+    {
+        std::uniform_real_distribution<float> uniform(0.0, 1.0);
+        field.resize(width * height);
+        for(size_t i = 0; i < field.size(); i++)
+        {
+            field[i] = uniform(rng);
+        }
+        for(int i = 0; i < SMOOTHING_PASSES; i++)
+        {
+            smooth(field, width, height);
+        }
+        normalize(field);
+    }
+
+    inline hlt::Location neighbor(const hlt::GameMap &map, int x, int y, int direction)
+    {
+        if(direction == NORTH) y = (y == 0) ? map.height - 1 : y - 1;
+        else if(direction == EAST) x = (x == map.width - 1) ? 0 : x + 1;
+        else if(direction == SOUTH) y = (y == map.height - 1) ? 0 : y + 1;
+        else if(direction == WEST) x = (x == 0) ? map.width - 1 : x - 1;
+        hlt::Location location = {(unsigned short) x, (unsigned short) y};
+        return location;
+    }
+}
+
+//Players get one tile each out of a cols x rows grid, every tile a copy of the same random one, so no start is
+//better than another. width and height are rounded down to a multiple of the grid.
+inline void generate_local_game(LocalGame &game, int width, int height, int num_players, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    int rows = 1;
+    for(int r = 1; r * r <= num_players; r++)
+    {
+        if(num_players % r == 0)
+        {
+            rows = r;
+        }
+    }
+    int cols = num_players / rows;
+    int tile_width = width / cols;
+    int tile_height = height / rows;
+    std::vector<float> production;
+    std::vector<float> strength;
+    local_game_detail::random_field(production, tile_width, tile_height, rng);
+    local_game_detail::random_field(strength, tile_width, tile_height, rng);
+
+    game.map = hlt::GameMap(tile_width * cols, tile_height * rows);
+    for(int y = 0; y < game.map.height; y++)
+    {
+        for(int x = 0; x < game.map.width; x++)
+        {
+            int t = (y % tile_height) * tile_width + x % tile_width;
+            hlt::Site &site = game.map.contents[y][x];
+            site.owner = 0;
+            site.production = (unsigned char) (1 + std::floor(std::pow(production[t], 2.0f) * (MAX_PRODUCTION - 1) + 0.5));
+            site.strength = (unsigned char) std::floor(std::pow(strength[t], 1.5f) * 250 + 0.5);
+        }
+    }
+    std::uniform_int_distribution<int> start_x(0, tile_width - 1);
+    std::uniform_int_distribution<int> start_y(0, tile_height - 1);
+    int sx = start_x(rng);
+    int sy = start_y(rng);
+    for(int p = 0; p < num_players; p++)
+    {
+        hlt::Site &site = game.map.contents[(p / cols) * tile_height + sy][(p % cols) * tile_width + sx];
+        site.owner = p + 1;
+        site.strength = 255;
+    }
+
+    int cells = game.map.width * game.map.height;
+    game.num_players = num_players;
+    game.turn = 0;
+    game.max_turns = (int) (10 * std::sqrt((float) cells));
+    game.territory.assign(num_players, 1);
+    game.total_strength.assign(num_players, 255);
+    game.eliminated.assign(num_players, -1);
+    game.directions.assign(num_players, std::vector<unsigned char>(cells, STILL));
+    game.pieces.assign(num_players, std::vector<int>(cells, -1));
+    game.injury.assign(num_players, std::vector<int>(cells, -1));
+    game.neutral_damage.assign(cells, 0);
+}
+
+inline void set_local_moves(LocalGame &game, int player, const std::set<hlt::Move> &moves)
+{
+    for(std::set<hlt::Move>::const_iterator it = moves.begin(); it != moves.end(); ++it)
+    {
+        if((it->loc.x < game.map.width) && (it->loc.y < game.map.height) && (it->dir <= WEST))
+        {
+            game.directions[player - 1][it->loc.y * game.map.width + it->loc.x] = it->dir;
+        }
+    }
+}
+
+//Directions indexed y * width + x, like Bot::directions; only the squares player owns are taken
+inline void set_local_directions(LocalGame &game, int player, const std::vector<unsigned char> &directions)
+{
+    std::vector<unsigned char> &own = game.directions[player - 1];
+    for(int y = 0; y < game.map.height; y++)
+    {
+        for(int x = 0; x < game.map.width; x++)
+        {
+            if(game.map.contents[y][x].owner == player)
+            {
+                own[y * game.map.width + x] = directions[y * game.map.width + x];
+            }
+        }
+    }
+}
+
+inline bool local_game_over(const LocalGame &game)
+{
+    int alive = 0;
+    for(int p = 0; p < game.num_players; p++)
+    {
+        alive += (game.eliminated[p] == -1);
+    }
+    return (alive <= 1) || (game.turn >= game.max_turns);
+}
+
+//Applies the directions set since the last turn: production for squares that stay, moves merged and capped at 255,
+//then every piece damages enemy pieces on and next to its square, neutral squares only fight what is on them.
+inline void play_local_turn(LocalGame &game)
+{
+    hlt::GameMap &map = game.map;
+    int width = map.width;
+    int cells = width * map.height;
+    for(int p = 0; p < game.num_players; p++)
+    {
+        std::fill(game.pieces[p].begin(), game.pieces[p].end(), -1);
+        std::fill(game.injury[p].begin(), game.injury[p].end(), -1);
+    }
+    std::fill(game.neutral_damage.begin(), game.neutral_damage.end(), 0);
+
+    for(int y = 0; y < map.height; y++)
+    {
+        for(int x = 0; x < width; x++)
+        {
+            hlt::Site &site = map.contents[y][x];
+            if(site.owner == 0)
+            {
+                continue;
+            }
+            int p = site.owner - 1;
+            int direction = game.directions[p][y * width + x];
+            int strength = site.strength;
+            if(direction == STILL)
+            {
+                strength = std::min(255, strength + site.production);
+            }
+            hlt::Location target = local_game_detail::neighbor(map, x, y, direction);
+            int &piece = game.pieces[p][target.y * width + target.x];
+            piece = (piece == -1) ? strength : std::min(255, piece + strength);
+            if(game.pieces[p][y * width + x] == -1)
+            {
+                game.pieces[p][y * width + x] = 0;//the square stays ours unless something takes it
+            }
+            site.owner = 0;
+            site.strength = 0;
+        }
+    }
+
+    for(int index = 0; index < cells; index++)
+    {
+        int x = index % width;
+        int y = index / width;
+        for(int p = 0; p < game.num_players; p++)
+        {
+            int strength = game.pieces[p][index];
+            if(strength == -1)
+            {
+                continue;
+            }
+            for(int q = 0; q < game.num_players; q++)
+            {
+                if(q == p)
+                {
+                    continue;
+                }
+                for(int d = 0; d < 5; d++)
+                {
+                    hlt::Location near = local_game_detail::neighbor(map, x, y, DIRECTIONS[d]);
+                    int n = near.y * width + near.x;
+                    if(game.pieces[q][n] != -1)
+                    {
+                        game.injury[q][n] = std::max(game.injury[q][n], 0) + strength;
+                    }
+                }
+            }
+            if(map.contents[y][x].strength > 0)
+            {
+                game.injury[p][index] = std::max(game.injury[p][index], 0) + map.contents[y][x].strength;
+                game.neutral_damage[index] += strength;
+            }
+        }
+    }
+
+    for(int index = 0; index < cells; index++)
+    {
+        hlt::Site &site = map.contents[index / width][index % width];
+        site.strength = (unsigned char) std::max(0, site.strength - game.neutral_damage[index]);
+        for(int p = 0; p < game.num_players; p++)
+        {
+            int &piece = game.pieces[p][index];
+            if((piece != -1) && (game.injury[p][index] != -1))
+            {
+                piece = (game.injury[p][index] >= piece) ? -1 : piece - game.injury[p][index];
+            }
+        }
+    }
+
+    std::fill(game.territory.begin(), game.territory.end(), 0);
+    std::fill(game.total_strength.begin(), game.total_strength.end(), 0);
+    for(int index = 0; index < cells; index++)
+    {
+        hlt::Site &site = map.contents[index / width][index % width];
+        for(int p = 0; p < game.num_players; p++)
+        {
+            if(game.pieces[p][index] != -1)
+            {
+                site.owner = p + 1;
+                site.strength = game.pieces[p][index];
+                game.territory[p]++;
+                game.total_strength[p] += site.strength;
+            }
+        }
+    }
+
+    game.turn++;
+    for(int p = 0; p < game.num_players; p++)
+    {
+        std::fill(game.directions[p].begin(), game.directions[p].end(), STILL);
+        if((game.eliminated[p] == -1) && (game.territory[p] == 0))
+        {
+            game.eliminated[p] = game.turn;
+        }
+    }
+}
+
+//Opponent for the tools: captures the weakest neighbor it can beat, otherwise waits for 5 turns of production and walks to the nearest
+//square it does not own
+inline void get_greedy_moves(const hlt::GameMap &map, unsigned char id, std::set<hlt::Move> &moves)
+{
+    for(int y = 0; y < map.height; y++)
+    {
+        for(int x = 0; x < map.width; x++)
+        {
+            const hlt::Site &site = map.contents[y][x];
+            if(site.owner != id)
+            {
+                continue;
+            }
+            hlt::Location location = {(unsigned short) x, (unsigned short) y};
+            unsigned char best_dir = STILL;
+            float best_value = -1.0;
+            bool interior = true;
+            for(int i = 0; i < 4; i++)
+            {
+                hlt::Location n = local_game_detail::neighbor(map, x, y, CARDINALS[i]);
+                const hlt::Site &target = map.contents[n.y][n.x];
+                if(target.owner == id)
+                {
+                    continue;
+                }
+                interior = false;
+                float value = (target.production + 1.0) / (target.strength + 1.0);
+                if((target.strength < site.strength) && (value > best_value))
+                {
+                    best_value = value;
+                    best_dir = CARDINALS[i];
+                }
+            }
+            if(interior && (site.strength >= 5 * site.production))
+            {
+                int best_dist = std::max(map.width, map.height);
+                for(int i = 0; i < 4; i++)
+                {
+                    int dist = 0;
+                    hlt::Location n = location;
+                    while((map.contents[n.y][n.x].owner == id) && (dist < best_dist))
+                    {
+                        n = local_game_detail::neighbor(map, n.x, n.y, CARDINALS[i]);
+                        dist++;
+                    }
+                    if(dist < best_dist)
+                    {
+                        best_dist = dist;
+                        best_dir = CARDINALS[i];
+                    }
+                }
+            }
+            hlt::Move move = {location, best_dir};
+            moves.insert(move);
+        }
+    }
+}
+
+//1 for the winner. Survivors rank by territory, then strength; eliminated players by how long they lasted.
+inline int local_game_rank(const LocalGame &game, int player)
+{
+    int rank = 1;
+    int p = player - 1;
+    for(int q = 0; q < game.num_players; q++)
+    {
+        if(q == p)
+        {
+            continue;
+        }
+        bool better;
+        if((game.eliminated[p] == -1) != (game.eliminated[q] == -1))
+        {
+            better = (game.eliminated[q] == -1);
+        }
+        else if(game.eliminated[p] != -1)
+        {
+            better = (game.eliminated[q] > game.eliminated[p]) || ((game.eliminated[q] == game.eliminated[p]) && (q < p));
+        }
+        else
+        {
+            better = (game.territory[q] > game.territory[p]) ||
+                     ((game.territory[q] == game.territory[p]) && (game.total_strength[q] > game.total_strength[p])) ||
+                     ((game.territory[q] == game.territory[p]) && (game.total_strength[q] == game.total_strength[p]) && (q < p));
+        }
+        rank += better;
+    }
+    return rank;
+}
+
+#endif
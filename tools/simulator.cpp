@@ -0,0 +1,193 @@
+//Plays seeded local games between the bot and a field of opponents, all in one process, and reports how long the
+//bot takes per frame, how often it wins and how its territory grows over a game.
+//
+//  simulator [--games N] [--seed S] [--players P] [--width W] [--height H] [--opponent bot|greedy] [--curve FILE]
+//
+//Player 1 is always the bot. --opponent bot fills the other seats with copies of it (self-play, mostly useful for
+//timing), greedy with a simple expand-and-wait baseline that makes the win rate comparable between builds.
+//Without --width/--height every game draws its size from 20..50 like the 2016 server.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../bot.hpp"
+#include "local_game.hpp"
+
+const int CURVE_POINTS = 11;//territory share at 0%, 10%, ..., 100% of the turn limit
+
+struct SimulatorOptions
+{
+    int games;
+    unsigned seed;
+    int players;
+    int width;
+    int height;
+    bool greedy_opponents;
+    std::string curve_file;
+};
+
+double get_percentile(std::vector<double> &values, double fraction)
+{
+    if(values.empty())
+    {
+        return 0.0;
+    }
+    size_t k = std::min(values.size() - 1, (size_t) (fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+bool parse_options(int argc, char **argv, SimulatorOptions &options)
+{
+    options.games = 100;
+    options.seed = 1;
+    options.players = 2;
+    options.width = 0;
+    options.height = 0;
+    options.greedy_opponents = true;
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        if(!strcmp(argv[i], "--games")) options.games = atoi(argv[i + 1]);
+        else if(!strcmp(argv[i], "--seed")) options.seed = strtoul(argv[i + 1], NULL, 10);
+        else if(!strcmp(argv[i], "--players")) options.players = atoi(argv[i + 1]);
+        else if(!strcmp(argv[i], "--width")) options.width = atoi(argv[i + 1]);
+        else if(!strcmp(argv[i], "--height")) options.height = atoi(argv[i + 1]);
+        else if(!strcmp(argv[i], "--opponent")) options.greedy_opponents = !strcmp(argv[i + 1], "greedy");
+        else if(!strcmp(argv[i], "--curve")) options.curve_file = argv[i + 1];
+        else return false;
+    }
+    return (argc % 2 == 1) && (options.games > 0) && (options.players >= 2) && (options.players <= MAX_PLAYERS);
+}
+
+int main(int argc, char **argv)
+{
+    SimulatorOptions options;
+    if(!parse_options(argc, argv, options))
+    {
+        fprintf(stderr, "usage: %s [--games N] [--seed S] [--players 2..%d] [--width W] [--height H] [--opponent bot|greedy] [--curve FILE]\n", argv[0], MAX_PLAYERS);
+        return 1;
+    }
+    std::ofstream curve_file;
+    if(!options.curve_file.empty())
+    {
+        curve_file.open(options.curve_file.c_str());
+        curve_file << "game,seed,width,height";
+        for(int i = 0; i < CURVE_POINTS; i++)
+        {
+            curve_file << ",t" << i * 10;
+        }
+        curve_file << ",rank" << std::endl;
+    }
+
+    WorkerPool pool(get_planner_threads());
+    static Bot bots[MAX_PLAYERS];
+    LocalGame game;
+    std::set<hlt::Move> moves;
+    std::vector<double> frame_ms;
+    std::vector<double> curve_sum(CURVE_POINTS, 0.0);
+    std::mt19937 size_rng(options.seed);
+    std::uniform_int_distribution<int> size_step(0, 6);
+    int wins = 0;
+    double rank_sum = 0.0;
+    double share_sum = 0.0;
+    std::chrono::steady_clock::time_point batch_start = std::chrono::steady_clock::now();
+
+    for(int g = 0; g < options.games; g++)
+    {
+        unsigned seed = options.seed + g;
+        int width = options.width ? options.width : 20 + 5 * size_step(size_rng);
+        int height = options.height ? options.height : 20 + 5 * size_step(size_rng);
+        generate_local_game(game, width, height, options.players, seed);
+        int bot_seats = options.greedy_opponents ? 1 : options.players;
+        for(int p = 0; p < bot_seats; p++)
+        {
+            init_bot(bots[p], p + 1, game.map, pool);
+        }
+        int cells = game.map.width * game.map.height;
+        std::vector<double> curve(CURVE_POINTS, -1.0);
+        curve[0] = 1.0 / cells;
+
+        while(!local_game_over(game))
+        {
+            for(int p = 0; p < options.players; p++)
+            {
+                if(game.eliminated[p] != -1)
+                {
+                    continue;
+                }
+                if(p < bot_seats)
+                {
+                    bots[p].deadline.start();
+                    plan_frame(bots[p], game.map);
+                    frame_ms.push_back(bots[p].deadline.elapsed_ms());
+                    set_local_directions(game, p + 1, bots[p].directions);
+                }
+                else
+                {
+                    moves.clear();
+                    get_greedy_moves(game.map, p + 1, moves);
+                    set_local_moves(game, p + 1, moves);
+                }
+            }
+            play_local_turn(game);
+            for(int i = 1; i < CURVE_POINTS; i++)
+            {
+                if((curve[i] < 0.0) && (game.turn * (CURVE_POINTS - 1) >= i * game.max_turns))
+                {
+                    curve[i] = (double) game.territory[0] / cells;
+                }
+            }
+        }
+        for(int i = 1; i < CURVE_POINTS; i++)
+        {
+            if(curve[i] < 0.0)
+            {
+                curve[i] = (double) game.territory[0] / cells;//the game ended before reaching this point
+            }
+            curve_sum[i] += curve[i];
+        }
+        curve_sum[0] += curve[0];
+
+        int rank = local_game_rank(game, 1);
+        wins += (rank == 1);
+        rank_sum += rank;
+        share_sum += (double) game.territory[0] / cells;
+        if(curve_file.is_open())
+        {
+            curve_file << g << "," << seed << "," << game.map.width << "," << game.map.height;
+            for(int i = 0; i < CURVE_POINTS; i++)
+            {
+                curve_file << "," << curve[i];
+            }
+            curve_file << "," << rank << std::endl;
+        }
+    }
+
+    double batch_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - batch_start).count();
+    printf("games %d, players %d, opponent %s, seeds %u..%u, %.1f s\n", options.games, options.players,
+           options.greedy_opponents ? "greedy" : "bot", options.seed, options.seed + options.games - 1, batch_s);
+    printf("win rate %.3f, mean rank %.2f, mean final territory %.3f\n", (double) wins / options.games,
+           rank_sum / options.games, share_sum / options.games);
+    size_t frames = frame_ms.size();
+    double p50 = get_percentile(frame_ms, 0.5);
+    double p90 = get_percentile(frame_ms, 0.9);
+    double p99 = get_percentile(frame_ms, 0.99);
+    double p999 = get_percentile(frame_ms, 0.999);
+    double worst = frame_ms.empty() ? 0.0 : *std::max_element(frame_ms.begin(), frame_ms.end());
+    printf("frame ms over %zu frames: p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f\n", frames, p50, p90, p99, p999, worst);
+    printf("mean territory share by turn:");
+    for(int i = 0; i < CURVE_POINTS; i++)
+    {
+        printf(" %d%%:%.3f", i * 10, curve_sum[i] / options.games);
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,54 @@
+//Prints a trace written with BOT_TRACE as text, one record per line:
+//
+//  trace_dump trace.bin [width]
+//
+//With the map width, squares are printed as x,y instead of as indices.
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "../trace_log.hpp"
+
+const char *TRACE_EVENT_NAMES[] = {"frame", "deadline", "territory_mismatch", "interior", "capture", "wait",
+                                   "towards_target", "reserve_own", "reserve_enemy", "direction", "dropped",
+                                   "contact_zone", "slow_frame",
+                                   "speculation", "allocation"};
+
+void print_square(int index, int width)
+{
+    if((index < 0) || (width <= 0))
+    {
+        printf(" %d", index);
+    }
+    else
+    {
+        printf(" %d,%d", index % width, index / width);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if((argc < 2) || (argc > 3))
+    {
+        fprintf(stderr, "usage: %s trace.bin [width]\n", argv[0]);
+        return 1;
+    }
+    FILE *file = fopen(argv[1], "rb");
+    if(file == NULL)
+    {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    int width = (argc == 3) ? atoi(argv[2]) : 0;
+    int event_count = sizeof(TRACE_EVENT_NAMES) / sizeof(TRACE_EVENT_NAMES[0]);
+    TraceRecord record;
+    while(fread(&record, sizeof(record), 1, file) == 1)
+    {
+        printf("%u %s", record.frame, (record.event < event_count) ? TRACE_EVENT_NAMES[record.event] : "?");
+        print_square(record.square, width);
+        print_square(record.target, width);
+        printf(" %u %d\n", record.direction, record.value);
+    }
+    fclose(file);
+    return 0;
+}
@@ -0,0 +1,165 @@
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+const int TRACE_CAPACITY = 1 << 16;//records, a power of two
+const int TRACE_DRAIN_INTERVAL_MS = 2;
+
+enum TraceEvent
+{
+    TRACE_FRAME,//square: best border target, value: squares we own
+    TRACE_DEADLINE,//value: squares left with their cheap move
+    TRACE_TERRITORY_MISMATCH,//DEBUG builds only. square: incremental best target, target: what a full scan picks
+    TRACE_INTERIOR,//square follows the force field, target: where to
+    TRACE_CAPTURE,//square attacks target
+    TRACE_WAIT,//square is too weak and stays
+    TRACE_TOWARDS_TARGET,//square heads for the best border target, target: the goal
+    TRACE_RESERVE_OWN,//target: square of ours, value: strength reserved on it afterwards
+    TRACE_RESERVE_ENEMY,//target: square we attack, value: strength sent into it afterwards
+    TRACE_DIRECTION,//direction committed for square
+    TRACE_DROPPED,//value: records lost because the ring buffer was full
+    TRACE_CONTACT_ZONE,//square: first square of a simulated contact zone, value: squares in it
+    TRACE_SLOW_FRAME,//frame ended close to the time limit, target: its slowest FramePhase, value: microseconds it took
+    TRACE_SPECULATION,//value: bitmask of the force field directions taken from the speculation on this frame
+    TRACE_ALLOCATION//BOT_FIXED_MEMORY only. value: operator new calls since the previous frame
+};
+
+struct TraceRecord
+{
+    unsigned short frame;
+    unsigned char event;
+    unsigned char direction;
+    int square;
+    int target;
+    int value;
+};
+
+//Binary event log. The planning thread appends fixed-size records to a single-producer single-consumer ring buffer
+//and a background thread drains it to a file, so tracing never waits on I/O; when the drain falls behind, records
+//are dropped and counted instead. While disabled, trace() is a single branch. Records are written in native byte
+//order, tools/trace_dump.cpp prints them. The log is enabled from open() to close(); both, like trace(), belong to
+//the planning thread.
+class TraceLog
+{
+public:
+    unsigned short frame;
+
+    TraceLog() : frame(0), enabled(false), file(NULL), head(0), tail(0), stopping(false), dropped(0)
+    {
+    }
+
+    ~TraceLog()
+    {
+        close();
+    }
+
+    bool open(const char *path)
+    {
+        close();
+        file = fopen(path, "wb");
+        if(file == NULL)
+        {
+            return false;
+        }
+        records.resize(TRACE_CAPACITY);
+        head.store(0);
+        tail.store(0);
+        stopping.store(false);
+        dropped = 0;
+        drainer = std::thread(&TraceLog::drain, this);
+        enabled = true;
+        return true;
+    }
+
+    bool is_enabled() const
+    {
+        return enabled;
+    }
+
+    void trace(TraceEvent event, int square, int target = -1, unsigned char direction = 0, int value = 0)
+    {
+        if(!enabled)
+        {
+            return;
+        }
+        unsigned position = head.load(std::memory_order_relaxed);
+        if(position - tail.load(std::memory_order_acquire) == (unsigned) TRACE_CAPACITY)
+        {
+            dropped++;
+            return;
+        }
+        TraceRecord &record = records[position & (TRACE_CAPACITY - 1)];
+        record.frame = frame;
+        record.event = event;
+        record.direction = direction;
+        record.square = square;
+        record.target = target;
+        record.value = value;
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    //Drains what is left and closes the file
+    void close()
+    {
+        if(file == NULL)
+        {
+            return;
+        }
+        enabled = false;
+        stopping.store(true);
+        drainer.join();
+        if(dropped != 0)
+        {
+            TraceRecord record = {frame, TRACE_DROPPED, 0, -1, -1, dropped};
+            fwrite(&record, sizeof(record), 1, file);
+        }
+        fclose(file);
+        file = NULL;
+    }
+
+private:
+    TraceLog(const TraceLog &);
+    TraceLog &operator=(const TraceLog &);
+
+    void drain()
+    {
+        while(true)
+        {
+            bool last = stopping.load();
+            unsigned begin = tail.load(std::memory_order_relaxed);
+            unsigned end = head.load(std::memory_order_acquire);
+            while(begin != end)
+            {
+                unsigned first = begin & (TRACE_CAPACITY - 1);
+                unsigned count = std::min(end - begin, (unsigned) TRACE_CAPACITY - first);
+                fwrite(&records[first], sizeof(TraceRecord), count, file);
+                begin += count;
+                tail.store(begin, std::memory_order_release);
+            }
+            if(last)
+            {
+                break;
+            }
+            fflush(file);
+            std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_DRAIN_INTERVAL_MS));
+        }
+        fflush(file);
+    }
+
+    bool enabled;
+    FILE *file;
+    std::vector<TraceRecord> records;
+    std::atomic<unsigned> head;
+    std::atomic<unsigned> tail;
+    std::atomic<bool> stopping;
+    int dropped;
+    std::thread drainer;
+};
+
+#endif
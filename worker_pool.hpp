@@ -0,0 +1,128 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Persistent threads that split [0, count) into tiles and run a task over them. The calling thread works on tiles
+//too, so a pool of size 1 has no workers at all and run() is a plain function call.
+class WorkerPool
+{
+public:
+    typedef void (*Task)(void *context, int begin, int end);
+
+    explicit WorkerPool(int threads) : task(NULL), context(NULL), count(0), tile_size(1), generation(0), pending(0), stopping(false)
+    {
+        for(int i = 1; i < threads; i++)
+        {
+            workers.push_back(std::thread(&WorkerPool::work, this));
+        }
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(size_t i = 0; i < workers.size(); i++)
+        {
+            workers[i].join();
+        }
+    }
+
+    int size() const
+    {
+        return workers.size() + 1;
+    }
+
+    //Returns once every tile has been processed
+    void run(int count, int tile_size, Task task, void *context)
+    {
+        if(workers.empty() || (count <= tile_size))
+        {
+            task(context, 0, count);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            this->task = task;
+            this->context = context;
+            this->count = count;
+            this->tile_size = tile_size;
+            next_tile.store(0);
+            pending = workers.size();
+            generation++;
+        }
+        wake.notify_all();
+        run_tiles();
+        std::unique_lock<std::mutex> lock(mutex);
+        while(pending != 0)
+        {
+            done.wait(lock);
+        }
+    }
+
+private:
+    WorkerPool(const WorkerPool &);
+    WorkerPool &operator=(const WorkerPool &);
+
+    void run_tiles()
+    {
+        while(true)
+        {
+            int begin = next_tile.fetch_add(tile_size);
+            if(begin >= count)
+            {
+                break;
+            }
+            task(context, begin, std::min(begin + tile_size, count));
+        }
+    }
+
+    void work()
+    {
+        unsigned seen = 0;
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while(!stopping && (generation == seen))
+                {
+                    wake.wait(lock);
+                }
+                if(stopping)
+                {
+                    return;
+                }
+                seen = generation;
+            }
+            run_tiles();
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--pending == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    Task task;
+    void *context;
+    int count;
+    int tile_size;
+    std::atomic<int> next_tile;
+    unsigned generation;
+    int pending;
+    bool stopping;
+};
+
+#endif